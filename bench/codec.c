@@ -0,0 +1,52 @@
+#include <stdio.h>
+
+#include "cancel.h"
+#include "codec.h"
+#include "common.h"
+#include "dynarr.h"
+#include "step.h"
+
+#define NUM_ROUNDS 200
+
+// Encodes and decodes the steps of every benchmark puzzle NUM_ROUNDS times,
+// reusing one buffer so the timings leave allocation out
+int main(void) {
+    Steps steps;
+    da_init(&steps);
+    for (int i = 0; i < bench_num_puzzles; i++) {
+        bench_solve(bench_puzzles[i], &steps);
+    }
+
+    Bytes bytes;
+    da_init(&bytes);
+    long long start = cancel_now_ns();
+    for (int round = 0; round < NUM_ROUNDS; round++) {
+        da_clear(&bytes);
+        for (int i = 0; i < steps.len; i++) {
+            step_encode(&bytes, &steps.elems[i]);
+        }
+    }
+    double encode_ms = bench_ms_since(start);
+
+    Step step;
+    int checksum = 0;
+    start = cancel_now_ns();
+    for (int round = 0; round < NUM_ROUNDS; round++) {
+        int pos = 0;
+        while (pos < bytes.len) {
+            pos += step_decode(&bytes.elems[pos], bytes.len - pos, &step);
+            checksum += step.tech;
+        }
+    }
+    double decode_ms = bench_ms_since(start);
+
+    long long total = (long long)steps.len * NUM_ROUNDS;
+    printf("codec: %d steps, %.1f bytes per step against %zu for a Step\n",
+           steps.len, (double)bytes.len / steps.len, sizeof(Step));
+    printf("codec: encode %.1f M steps/s, decode %.1f M steps/s (%d)\n",
+           total / encode_ms / 1e3, total / decode_ms / 1e3, checksum);
+
+    da_deinit(&bytes);
+    da_deinit(&steps);
+    return 0;
+}
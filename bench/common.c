@@ -0,0 +1,46 @@
+#include "common.h"
+
+#include "cancel.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "solver.h"
+#include "step.h"
+
+// Minimal puzzles spread from singles only up to forcing chains, so every
+// benchmark sees a mix of cheap and expensive steps
+char *bench_puzzles[] = {
+    "000005410001800000095000062070004900000070000300600000108400705064050031000010000",
+    "009700032050200040000009000000008000040590010080001005003000060600980000007020000",
+    "000050039800020040900078200209000400000007006040000008100000000007306000086000007",
+    "000003007800000000050082403900050000600100008140007005000070002000906800400008056",
+    "600000090098000007007000250000305600000000070204080000500003160800020040040800005",
+    "007802600000040090000030040080000000600150200310200070001700000208000900000400016",
+    "070000800900040003040206070020000090010800000500010008000091005400000000200060749",
+    "040100005010800760000090800360000000000030002000065003000000050850000090002004006",
+    "020840003030000005801050000000070000004605000908200700070096080300000050000000130",
+    "000307860010060042900000700500000400009002007000108090000000000076040050035000000",
+    "470903008900002000050000300007021030300070025010008600020064000600000500090000010",
+    "000090000890500060002003005000000800050030907270900000300804700004000080000052304",
+    "800104600400007008000052040010900036000000900000006000100080200705600000000030790",
+    "009800070032000040400009830003100000000460020600000001050070002300000000908602000",
+    "000300506000000000079408000080006000000920008690500020103000069400000700020000300",
+    "006008200100000000290010070510000030000300708023096005000960000000007000000082510",
+};
+int bench_num_puzzles = sizeof(bench_puzzles) / sizeof(*bench_puzzles);
+
+// Appends every step of the solve to out, in the default technique order
+void bench_solve(char *puzzle, Steps *out) {
+    Grid *grid = grid_create(puzzle);
+
+    Step step;
+    while (solver_next_step(grid, &step) == SOLVE_ONGOING) {
+        da_append(out, step);
+        solver_apply_step(grid, &step);
+    }
+
+    grid_destroy(grid);
+}
+
+double bench_ms_since(long long start_ns) {
+    return (cancel_now_ns() - start_ns) / 1e6;
+}
@@ -0,0 +1,12 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "step.h"
+
+extern char *bench_puzzles[];
+extern int bench_num_puzzles;
+
+void bench_solve(char *puzzle, Steps *out);
+double bench_ms_since(long long start_ns);
+
+#endif
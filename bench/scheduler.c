@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "cancel.h"
+#include "codec.h"
+#include "common.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "scheduler.h"
+#include "solver.h"
+#include "step.h"
+
+static void solve_naive(char *puzzle, Bytes *out);
+static void solve_scheduled(char *puzzle, Bytes *out);
+
+// Solves every benchmark puzzle in the fixed technique order and through the
+// scheduler, and checks that both take the same steps
+int main(void) {
+    Bytes naive;
+    Bytes scheduled;
+    da_init(&naive);
+    da_init(&scheduled);
+
+    long long start = cancel_now_ns();
+    for (int i = 0; i < bench_num_puzzles; i++) {
+        solve_naive(bench_puzzles[i], &naive);
+    }
+    double naive_ms = bench_ms_since(start);
+
+    start = cancel_now_ns();
+    for (int i = 0; i < bench_num_puzzles; i++) {
+        solve_scheduled(bench_puzzles[i], &scheduled);
+    }
+    double scheduled_ms = bench_ms_since(start);
+
+    bool is_same = naive.len == scheduled.len
+                   && memcmp(naive.elems, scheduled.elems, naive.len) == 0;
+    printf("scheduler: fixed order %.1f ms, scheduled %.1f ms (%.2fx), "
+           "%s steps\n",
+           naive_ms, scheduled_ms, naive_ms / scheduled_ms,
+           is_same ? "same" : "different");
+
+    da_deinit(&naive);
+    da_deinit(&scheduled);
+    return is_same ? 0 : 1;
+}
+
+static void solve_naive(char *puzzle, Bytes *out) {
+    Grid *grid = grid_create(puzzle);
+
+    Step step;
+    while (solver_next_step(grid, &step) == SOLVE_ONGOING) {
+        step_encode(out, &step);
+        solver_apply_step(grid, &step);
+    }
+
+    grid_destroy(grid);
+}
+
+static void solve_scheduled(char *puzzle, Bytes *out) {
+    Grid *grid = grid_create(puzzle);
+    Scheduler sched;
+    scheduler_init(&sched);
+
+    Step step;
+    while (scheduler_next_step(&sched, grid, &step) == SOLVE_ONGOING) {
+        step_encode(out, &step);
+        solver_apply_step(grid, &step);
+    }
+
+    grid_destroy(grid);
+}
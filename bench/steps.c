@@ -0,0 +1,135 @@
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cancel.h"
+#include "common.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "solver.h"
+#include "step.h"
+#include "step_sink.h"
+#include "techniques/registry.h"
+
+// Franken and Mutant Fish can find over a thousand steps in one grid, which
+// would take over an hour to reach by restarting, so both searches stop a
+// technique after this many steps
+#define MAX_STEPS_PER_TECHNIQUE 16
+// Only every few grids of each solve are searched, to keep the run short
+#define GRID_STRIDE 4
+
+// Appends up to MAX_STEPS_PER_TECHNIQUE steps to out
+typedef struct {
+    Steps *out;
+} FirstSteps;
+
+// Keeps the step at index skip and stops there, as a search that can only
+// return its first hit would have to be restarted to reach it
+typedef struct {
+    Step *out;
+    int skip;
+} NthStep;
+
+static bool emit_first_steps(StepSink *sink, Step *step);
+static bool emit_nth(StepSink *sink, Step *step);
+static int find_all(Grid *grid);
+static int find_by_restarting(Grid *grid);
+
+// Lists every step available at each point of the benchmark solves, once by
+// letting each technique run to the end and once by restarting it after each
+// step it finds, and checks that both find the same number. The distinct
+// steps are counted with the solver's own, uncapped enumeration
+int main(void) {
+    Steps solve;
+    da_init(&solve);
+
+    double all_ms = 0;
+    double restart_ms = 0;
+    double distinct_ms = 0;
+    long long num_all = 0;
+    long long num_restart = 0;
+    long long num_distinct = 0;
+    for (int i = 0; i < bench_num_puzzles; i++) {
+        da_clear(&solve);
+        bench_solve(bench_puzzles[i], &solve);
+
+        Grid *grid = grid_create(bench_puzzles[i]);
+        for (int j = 0; j <= solve.len; j += GRID_STRIDE) {
+            long long start = cancel_now_ns();
+            num_all += find_all(grid);
+            all_ms += bench_ms_since(start);
+
+            start = cancel_now_ns();
+            num_restart += find_by_restarting(grid);
+            restart_ms += bench_ms_since(start);
+
+            Steps distinct;
+            da_init(&distinct);
+            start = cancel_now_ns();
+            num_distinct += solver_all_steps(grid, &distinct);
+            distinct_ms += bench_ms_since(start);
+            da_deinit(&distinct);
+
+            for (int k = j; k < j + GRID_STRIDE && k < solve.len; k++) {
+                solver_apply_step(grid, &solve.elems[k]);
+            }
+        }
+        grid_destroy(grid);
+    }
+
+    bool is_same = num_all == num_restart;
+    printf("steps: one pass %.1f ms, restarting %.1f ms (%.2fx), "
+           "%lld steps (%s)\n",
+           all_ms, restart_ms, restart_ms / all_ms, num_all,
+           is_same ? "same" : "different");
+    printf("steps: uncapped %.1f ms, %lld distinct steps\n", distinct_ms,
+           num_distinct);
+
+    da_deinit(&solve);
+    return is_same ? 0 : 1;
+}
+
+static bool emit_first_steps(StepSink *sink, Step *step) {
+    FirstSteps *first = sink->data;
+    da_append(first->out, *step);
+    return sink->num_steps < MAX_STEPS_PER_TECHNIQUE;
+}
+
+static bool emit_nth(StepSink *sink, Step *step) {
+    NthStep *nth = sink->data;
+    if (sink->num_steps <= nth->skip) return true;
+
+    *nth->out = *step;
+    return false;
+}
+
+static int find_all(Grid *grid) {
+    Steps steps;
+    da_init(&steps);
+
+    FirstSteps first = {.out = &steps};
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        StepSink sink = {
+            .emit = emit_first_steps, .data = &first, .num_steps = 0};
+        techniques[i].find_all(grid, &sink);
+    }
+
+    int num_steps = steps.len;
+    da_deinit(&steps);
+    return num_steps;
+}
+
+static int find_by_restarting(Grid *grid) {
+    int num_steps = 0;
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        Step step;
+        NthStep nth = {.out = &step, .skip = 0};
+        while (nth.skip < MAX_STEPS_PER_TECHNIQUE) {
+            StepSink sink = {.emit = emit_nth, .data = &nth, .num_steps = 0};
+            techniques[i].find_all(grid, &sink);
+            if (sink.num_steps <= nth.skip) break;
+            nth.skip++;
+        }
+        num_steps += nth.skip;
+    }
+    return num_steps;
+}
@@ -0,0 +1,47 @@
+#ifndef ALS_H
+#define ALS_H
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cell.h"
+
+// Every subset of a unit's 9 cells
+#define NUM_UNIT_SETS 512
+#define ALL_POSITIONS 0x1ff
+
+// The almost locked sets of every unit: n empty cells holding n + 1 candidates
+// between them. A set is a mask of positions in its unit, as IDX_FROM_UNIT
+// numbers them, and bit mask of is_als[unit] is set for each one. cands is what
+// the sets were last built from, so als_update only redoes the units that
+// changed
+typedef struct {
+    unsigned long long is_als[27][NUM_UNIT_SETS / 64];
+    unsigned int cands[81];
+    bool is_built;
+} AlsIndex;
+
+// A set laid out for the ALS techniques. cells_with holds the set's cells with
+// each digit and sees the cells that see all of those
+typedef struct {
+    Bitboard cells;
+    unsigned int cands;
+    Bitboard cells_with[9];
+    Bitboard sees[9];
+} Als;
+
+typedef struct {
+    Als *elems;
+    int len;
+    int cap;
+} Alses;
+
+void als_init(AlsIndex *index);
+void als_update(AlsIndex *index, Cell cells[81]);
+int als_unit_sets(AlsIndex *index, int unit, int within,
+                  int out[NUM_UNIT_SETS]);
+unsigned int als_set_cands(AlsIndex *index, int unit, int set);
+Bitboard als_set_cells(int unit, int set);
+void als_collect(AlsIndex *index, Bitboard peer_masks[81], Alses *out);
+
+#endif
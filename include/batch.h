@@ -0,0 +1,21 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "grid.h"
+#include "history.h"
+#include "rating.h"
+#include "scheduler.h"
+#include "solver.h"
+
+#define MAX_LINE_LEN 256
+
+int batch_run(char *puzzles_path, char *trace_path, long long budget_ns,
+              int max_steps);
+bool batch_read_puzzle(FILE *file, char out[MAX_LINE_LEN]);
+SolveStatus batch_solve(Grid *grid, History *hist,
+                        TechniqueCost costs[NUM_TECHNIQUES], Rating *rating);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+
+// A set of cells. Bit i of lo is cell i for the first 64 cells, and bit i of
+// hi is cell 64 + i for the rest
+typedef struct {
+    unsigned long long lo;
+    unsigned long long hi;
+} Bitboard;
+
+Bitboard bb_empty(void);
+bool bb_is_empty(Bitboard bb);
+bool bb_equal(Bitboard a, Bitboard b);
+int bb_count(Bitboard bb);
+Bitboard bb_and(Bitboard a, Bitboard b);
+Bitboard bb_or(Bitboard a, Bitboard b);
+Bitboard bb_and_not(Bitboard a, Bitboard b);
+int bb_to_idxs(Bitboard bb, int out[]);
+
+// These run in the inner loops of most searches, so they are defined here to
+// be inlined
+
+static inline void bb_add(Bitboard *bb, int idx) {
+    if (idx < 64) {
+        bb->lo |= 1ull << idx;
+    } else {
+        bb->hi |= 1ull << (idx - 64);
+    }
+}
+
+static inline void bb_remove(Bitboard *bb, int idx) {
+    if (idx < 64) {
+        bb->lo &= ~(1ull << idx);
+    } else {
+        bb->hi &= ~(1ull << (idx - 64));
+    }
+}
+
+static inline bool bb_has(Bitboard bb, int idx) {
+    return idx < 64 ? bb.lo >> idx & 1 : bb.hi >> (idx - 64) & 1;
+}
+
+// Returns the lowest cell in bb, or -1 if it's empty
+static inline int bb_first(Bitboard bb) {
+    if (bb.lo) return __builtin_ctzll(bb.lo);
+    if (bb.hi) return 64 + __builtin_ctzll(bb.hi);
+    return -1;
+}
+
+// Takes the lowest cell out of bb and returns it, or -1 if it's empty
+static inline int bb_pop(Bitboard *bb) {
+    if (bb->lo) {
+        int idx = __builtin_ctzll(bb->lo);
+        bb->lo &= bb->lo - 1;
+        return idx;
+    }
+    if (bb->hi) {
+        int idx = 64 + __builtin_ctzll(bb->hi);
+        bb->hi &= bb->hi - 1;
+        return idx;
+    }
+    return -1;
+}
+
+#endif
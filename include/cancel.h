@@ -0,0 +1,30 @@
+#ifndef CANCEL_H
+#define CANCEL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Number of cancel_check calls between reads of the clock
+#define CANCEL_CHECK_INTERVAL 64
+
+// Lets long searches give up part way. It is cancelled once its deadline
+// passes, once max_steps solver steps have been taken or when another thread
+// calls cancel_request. A zero budget or step limit means no limit. Only
+// cancelled may be touched by other threads, so a token with neither limit can
+// be shared by several searches
+typedef struct {
+    long long deadline_ns;
+    int max_steps;
+    int num_steps;
+    int countdown;
+    atomic_bool cancelled;
+} CancelToken;
+
+void cancel_init(CancelToken *token, long long budget_ns, int max_steps);
+void cancel_request(CancelToken *token);
+bool cancel_check(CancelToken *token);
+bool cancel_add_step(CancelToken *token);
+bool cancel_is_cancelled(CancelToken *token);
+long long cancel_now_ns(void);
+
+#endif
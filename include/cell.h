@@ -12,6 +12,13 @@
     ((ROW_FROM_IDX(i) % 3) * 3 + COL_FROM_IDX(i) % 3)
 
 #define IDX_FROM_ROW_COL(r, c) ((r) * 9 + c)
+#define IDX_FROM_BOX_POSITION(b, p) \
+    (((b) / 3 * 3 + (p) / 3) * 9 + (b) % 3 * 3 + (p) % 3)
+// Units are numbered like in SearchScope: rows, then columns, then boxes
+#define IDX_FROM_UNIT(u, i) \
+    ((u) < 9    ? IDX_FROM_ROW_COL(u, i) \
+     : (u) < 18 ? IDX_FROM_ROW_COL(i, (u) - 9) \
+                : IDX_FROM_BOX_POSITION((u) - 18, i))
 
 typedef struct {
     int value;
@@ -22,8 +29,7 @@ typedef struct {
     bool is_clue;
 } Cell;
 
-Cell *cell_create(int idx, int value, CandSet cands, bool is_clue);
-void cell_destroy(Cell *cell);
+void cell_init(Cell *cell, int idx, int value, CandSet cands, bool is_clue);
 int cell_idx(Cell *cell);
 bool cell_is_empty(Cell *cell);
 bool cell_eq(Cell *a, Cell *b);
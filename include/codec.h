@@ -0,0 +1,45 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cand_set.h"
+#include "grid.h"
+#include "step.h"
+
+typedef struct {
+    unsigned char *elems;
+    int len;
+    int cap;
+} Bytes;
+
+// Reads never go past end. A read that would, or a value out of its range,
+// sets failed and returns 0, so a step can be decoded to its end and checked
+// once
+typedef struct {
+    unsigned char *pos;
+    unsigned char *end;
+    bool failed;
+} Decoder;
+
+int step_encode(Bytes *out, Step *step);
+int step_decode(unsigned char *data, int size, Step *out);
+TechniqueType step_decode_tech(unsigned char *data, int size);
+
+void encode_uint(Bytes *out, unsigned int value);
+void encode_idxs(Bytes *out, int idxs[], int num_idxs);
+void encode_cand_set(Bytes *out, CandSet set);
+void encode_bitboard(Bytes *out, Bitboard bb);
+void encode_unit(Bytes *out, UnitType unit_type, int unit_idx);
+unsigned int decode_uint(Decoder *in);
+unsigned int decode_max(Decoder *in, unsigned int max);
+int decode_idx(Decoder *in);
+int decode_digit(Decoder *in);
+int decode_node(Decoder *in);
+int decode_idxs(Decoder *in, int out[], int max_idxs);
+CandSet decode_cand_set(Decoder *in);
+Bitboard decode_bitboard(Decoder *in);
+void decode_unit(Decoder *in, UnitType *out_type, int *out_idx);
+
+#endif
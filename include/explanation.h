@@ -0,0 +1,34 @@
+#ifndef EXPLANATION_H
+#define EXPLANATION_H
+
+#include "dynstr.h"
+#include "step.h"
+
+typedef struct {
+    int start;
+    int len;
+} Line;
+
+typedef struct {
+    Line *elems;
+    int len;
+    int cap;
+} Lines;
+
+// Text shown in the info window. lines holds text wrapped to width columns and
+// is only recomputed when a different width is asked for
+typedef struct {
+    DynStr text;
+    Lines lines;
+    int width;
+} Explanation;
+
+void explanation_init(Explanation *exp);
+Explanation *explanation_create(Step *step);
+void explanation_set_step(Explanation *exp, Step *step);
+void explanation_invalidate(Explanation *exp);
+void explanation_wrap(Explanation *exp, int width);
+void explanation_deinit(Explanation *exp);
+void explanation_destroy(Explanation *exp);
+
+#endif
@@ -3,12 +3,28 @@
 
 #include <stdbool.h>
 
+#include "als.h"
+#include "bitboard.h"
+#include "cancel.h"
 #include "cell.h"
+#include "links.h"
+#include "templates.h"
 
 #define NUM_PEERS 20
+#define CANDS_STR_LEN (3 + 81 * 2)
 #define MAX_COMMON_PEERS 13
+#define ALL_DIGITS 0x1ff
+#define ALL_UNITS 0x7ffffff
 
+// Limits technique searches to some digits and units. Bit d - 1 of digits is
+// digit d and bit type * 9 + idx of units is that unit
 typedef struct {
+    unsigned int digits;
+    unsigned int units;
+} SearchScope;
+
+typedef struct {
+    Cell cell_data[81];
     union {
         Cell *cells[81];
         Cell *rows[9][9];
@@ -16,9 +32,27 @@ typedef struct {
     Cell *cols[9][9];
     Cell *boxes[9][9];
     Cell *peers[81][NUM_PEERS];
+    Bitboard peer_masks[81];
+    Bitboard unit_masks[27];
     int empty_cells;
+    SearchScope scope;
+    CancelToken *cancel;
+    unsigned char solution[81];
+    bool has_solution;
+    // Allocated by the first technique that needs them, so grids that never
+    // get that far stay small. Clones start without them
+    LinkGraph *links;
+    AlsIndex *als;
+    TemplateIndex *templates;
 } Grid;
 
+// Only the cell data and the empty cell count change while solving. The unit
+// and peer tables point into cell_data, so they stay valid across a restore
+typedef struct {
+    Cell cell_data[81];
+    int empty_cells;
+} GridSnapshot;
+
 typedef enum {
     UNIT_ROW,
     UNIT_COL,
@@ -26,9 +60,22 @@ typedef enum {
 } UnitType;
 
 Grid *grid_create(char *grid_str);
+void grid_init(Grid *grid, char *grid_str);
+Grid *grid_clone(Grid *grid);
+void grid_deinit(Grid *grid);
 void grid_destroy(Grid *grid);
+void grid_to_cands_str(Grid *grid, char out[CANDS_STR_LEN + 1]);
+void grid_snapshot(Grid *grid, GridSnapshot *out);
+void grid_restore(Grid *grid, GridSnapshot *snapshot);
 bool grid_is_solved(Grid *grid);
 void grid_fill_cell(Grid *grid, Cell *cell, int value);
 int grid_common_peers(Grid *grid, Cell *cells[], int num_cells, Cell *out[]);
+bool grid_digit_in_scope(Grid *grid, int digit);
+bool grid_unit_in_scope(Grid *grid, UnitType unit_type, int unit_idx);
+bool grid_is_cancelled(Grid *grid);
+LinkGraph *grid_links(Grid *grid);
+AlsIndex *grid_als(Grid *grid);
+TemplateIndex *grid_templates(Grid *grid);
+Bitboard grid_cells_with_cand(Grid *grid, int cand);
 
 #endif
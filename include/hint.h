@@ -0,0 +1,30 @@
+#ifndef HINT_H
+#define HINT_H
+
+#include "dynstr.h"
+#include "step.h"
+
+typedef enum {
+    HINT_FOUND,
+    HINT_MISTAKES,
+    HINT_SOLVED,
+    HINT_STUCK,
+    HINT_TIMED_OUT,
+    HINT_INVALID
+} HintStatus;
+
+// Result of hint_find. The explanation buffer is kept between calls, so a
+// caller asking for hints repeatedly only allocates while it grows
+typedef struct {
+    Step step;
+    DynStr explanation;
+    int mistake_idxs[81];
+    int num_mistakes;
+} Hint;
+
+void hint_init(Hint *hint);
+char *hint_status_name(HintStatus status);
+HintStatus hint_find(char *grid_str, long long budget_ns, Hint *out);
+void hint_deinit(Hint *hint);
+
+#endif
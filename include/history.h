@@ -3,11 +3,40 @@
 
 #include <stdbool.h>
 
+#include "codec.h"
+#include "explanation.h"
 #include "grid.h"
 #include "step.h"
 
+#define HISTORY_CHECKPOINT_INTERVAL 16
+
+typedef struct {
+    GridSnapshot *elems;
+    int len;
+    int cap;
+} Checkpoints;
+
+typedef struct {
+    int *elems;
+    int len;
+    int cap;
+} Offsets;
+
+typedef struct {
+    Explanation **elems;
+    int len;
+    int cap;
+} Explanations;
+
+// Steps are kept encoded back to back in data and decoded when needed. curr is
+// the number of steps currently applied to the grid. Checkpoint i holds the
+// grid state after the first i * HISTORY_CHECKPOINT_INTERVAL steps. A step's
+// explanation is NULL until it's first asked for
 typedef struct {
-    Steps steps;
+    Bytes data;
+    Offsets offsets;
+    Checkpoints checkpoints;
+    Explanations explanations;
     int curr;
 } History;
 
@@ -15,8 +44,15 @@ bool history_can_undo(History *hist);
 bool history_can_redo(History *hist);
 bool history_undo(History *hist, Grid *grid);
 bool history_redo(History *hist, Grid *grid);
-Step *history_curr(History *hist);
-void history_add(History *hist, Step step);
+bool history_seek(History *hist, Grid *grid, int n);
+int history_len(History *hist);
+Step *history_step(History *hist, int i, Step *out);
+TechniqueType history_step_tech(History *hist, int i);
+Explanation *history_explanation(History *hist, int i);
+int history_find_tech(History *hist, TechniqueType tech, int from, int dir);
+Step *history_curr(History *hist, Step *out);
+Step *history_next(History *hist, Step *out);
+void history_add(History *hist, Step *step);
 void history_free(History *hist);
 
 #endif
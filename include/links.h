@@ -0,0 +1,49 @@
+#ifndef LINKS_H
+#define LINKS_H
+
+#include <stdbool.h>
+
+#include "cell.h"
+
+// A node is one candidate: digit d in cell idx
+#define NUM_NODES 729
+#define NODE(idx, digit) ((idx) * 9 + (digit) - 1)
+#define NODE_IDX(node) ((node) / 9)
+#define NODE_DIGIT(node) ((node) % 9 + 1)
+
+#define NO_LINK -1
+// The digit in the 20 peers and the other 8 digits of the cell
+#define MAX_WEAK_LINKS 28
+
+// Where a strong link comes from. The first three are the units where the
+// digit has only two places left and match UnitType. LINK_CELL joins the two
+// candidates of a bivalue cell
+typedef enum {
+    LINK_ROW,
+    LINK_COL,
+    LINK_BOX,
+    LINK_CELL,
+
+    NUM_LINK_KINDS
+} LinkKind;
+
+// Strong links between candidates, for chain techniques to share. strong holds
+// each node's partner for every kind of link, or NO_LINK. Weak links follow
+// from the candidates and are worked out when asked for. places and cands are
+// what the links were last built from, so links_update only redoes the units
+// and cells that changed since
+typedef struct {
+    short strong[NUM_NODES][NUM_LINK_KINDS];
+    unsigned short places[27][9];
+    unsigned int cands[81];
+    bool is_built;
+} LinkGraph;
+
+void links_init(LinkGraph *links);
+void links_update(LinkGraph *links, Cell cells[81]);
+bool links_has_node(LinkGraph *links, int node);
+int links_strong(LinkGraph *links, int node, int out[NUM_LINK_KINDS]);
+int links_weak(LinkGraph *links, int node, int out[MAX_WEAK_LINKS]);
+bool links_sees(int a, int b);
+
+#endif
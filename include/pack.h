@@ -0,0 +1,59 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "batch.h"
+#include "cancel.h"
+#include "history.h"
+#include "rating.h"
+#include "solver.h"
+#include "techniques/registry.h"
+
+#define PACK_MAX_WORKERS 8
+
+typedef enum {
+    PUZZLE_PENDING,
+    PUZZLE_SOLVING,
+    PUZZLE_DONE,
+} PuzzleState;
+
+// hist and rating hold the full trace and its rating once state is
+// PUZZLE_DONE
+typedef struct {
+    char grid_str[MAX_LINE_LEN];
+    PuzzleState state;
+    SolveStatus status;
+    Rating rating;
+    History hist;
+} PackPuzzle;
+
+typedef struct {
+    PackPuzzle *elems;
+    int len;
+    int cap;
+} PackPuzzles;
+
+// Puzzles are solved by a pool of worker threads, starting with the first
+// pending puzzle at or after cursor. Puzzle states, cursor and stop are shared
+// and guarded by lock. The rest of a puzzle belongs to the worker solving it
+// until it's done and to the caller from then on. Every worker's grid shares
+// cancel, which has no limits and only fires when the pack is closed
+typedef struct {
+    PackPuzzles puzzles;
+    pthread_t workers[PACK_MAX_WORKERS];
+    int num_workers;
+    pthread_mutex_t lock;
+    CancelToken cancel;
+    int cursor;
+    bool stop;
+} Pack;
+
+bool pack_open(Pack *pack, char *path);
+void pack_close(Pack *pack);
+void pack_set_cursor(Pack *pack, int cursor);
+PuzzleState pack_state(Pack *pack, int i);
+int pack_num_done(Pack *pack);
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef PROPAGATE_H
+#define PROPAGATE_H
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "grid.h"
+#include "links.h"
+
+// Each cell loses at most its 9 candidates and is placed once, so this many
+// changes can be undone however deep the assumptions go
+#define MAX_TRAIL (81 * 10)
+// A removal queues at most the naked single of its cell and a hidden single in
+// each of its units
+#define MAX_PROP_QUEUE (4 * MAX_TRAIL)
+#define NO_CAUSE -1
+
+typedef struct {
+    short idx;
+    unsigned short cands;
+    unsigned char value;
+} PropChange;
+
+// Where propagation broke down. With unit -1 it's cell idx, which was left with
+// no candidates, or with digit not 0, was forced to digit after losing it.
+// Otherwise digit has no place left in unit. cause is the placement that did it
+typedef struct {
+    int idx;
+    int unit;
+    int digit;
+    int cause;
+} PropConflict;
+
+// The candidates and values of a grid, with naked and hidden singles
+// propagated from assumptions instead of found by the techniques. Every change
+// goes on the trail first, so going back to a mark costs only what changed
+// since, with no grid copies. place_causes and removal_causes hold the
+// placement that forced each candidate in or out during the latest
+// propagation, which prop_chain follows back to the assumption
+typedef struct {
+    Bitboard *peer_masks;
+    unsigned short cands[81];
+    unsigned char values[81];
+    short place_causes[NUM_NODES];
+    short removal_causes[NUM_NODES];
+    PropChange trail[MAX_TRAIL];
+    int trail_len;
+    short queue[MAX_PROP_QUEUE];
+    short queue_causes[MAX_PROP_QUEUE];
+    int queue_len;
+    PropConflict conflict;
+} Propagator;
+
+void prop_init(Propagator *prop, Grid *grid);
+int prop_mark(Propagator *prop);
+void prop_undo(Propagator *prop, int mark);
+bool prop_assume(Propagator *prop, int node);
+bool prop_exclude(Propagator *prop, int node);
+bool prop_has_node(Propagator *prop, int node);
+bool prop_is_placed(Propagator *prop, int node);
+bool prop_is_solved(Propagator *prop);
+int prop_chain(Propagator *prop, int node, short out[], int max_len);
+
+#endif
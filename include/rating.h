@@ -0,0 +1,28 @@
+#ifndef RATING_H
+#define RATING_H
+
+#include <stdbool.h>
+
+#include "step.h"
+
+// Keeps a score well inside its range even over a large batch
+#define MAX_RATING_WEIGHT 10000
+
+// Difficulty of a solve. hardest is the technique with the highest weight
+// among the steps, or -1 if there were none. score adds up the weights of
+// every step, and guess_depth is the most guesses any step had to nest
+typedef struct {
+    int hardest;
+    long long score;
+    int guess_depth;
+    int counts[NUM_TECHNIQUES];
+} Rating;
+
+extern int rating_weights[NUM_TECHNIQUES];
+
+void rating_init(Rating *rating);
+void rating_add_step(Rating *rating, Step *step);
+void rating_add(Rating *total, Rating *rating);
+bool rating_load_weights(char *path, int *out_bad_line);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "grid.h"
+#include "solver.h"
+#include "step.h"
+
+// scoped counts the calls that were limited to the digits or units that
+// changed, which is where the scheduler saves over the fixed order
+typedef struct {
+    long long ns;
+    int calls;
+    int scoped;
+} TechniqueCost;
+
+// Finds the same steps as solver_next_step without rerunning searches that
+// can't succeed. Each call compares the grid with the one seen last time and
+// stamps the digits and units that changed with a new generation. A technique
+// that failed at generation fail_gens[i] is then limited to what changed after
+// it, or skipped altogether if nothing did. Techniques are indexed as in
+// techniques[]
+typedef struct {
+    unsigned int gen;
+    unsigned int digit_gens[9];
+    unsigned int unit_gens[27];
+    unsigned int fail_gens[NUM_TECHNIQUES];
+    int values[81];
+    unsigned int cands[81];
+    TechniqueCost costs[NUM_TECHNIQUES];
+} Scheduler;
+
+void scheduler_init(Scheduler *sched);
+SolveStatus scheduler_next_step(Scheduler *sched, Grid *grid, Step *step);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef SOLVE_AHEAD_H
+#define SOLVE_AHEAD_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "cancel.h"
+#include "grid.h"
+#include "solver.h"
+#include "step.h"
+
+// Runs the solver to the end on a background thread, using a private copy of
+// the grid. steps, status and stop are shared and guarded by lock. cancel
+// lets solve_ahead_stop interrupt a search that is under way
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    CancelToken cancel;
+    Grid *grid;
+    Steps steps;
+    SolveStatus status;
+    bool stop;
+} SolveAhead;
+
+void solve_ahead_start(SolveAhead *ahead, Grid *grid);
+void solve_ahead_stop(SolveAhead *ahead);
+bool solve_ahead_step(SolveAhead *ahead, int i, Step *out,
+                      SolveStatus *out_status);
+int solve_ahead_progress(SolveAhead *ahead, SolveStatus *out_status);
+
+#endif
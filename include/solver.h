@@ -1,17 +1,35 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <stdbool.h>
+
 #include "grid.h"
 #include "step.h"
 
+// Checking steps against the solution is cheap enough to leave on while
+// developing. Release builds only check when asked to
+#ifdef NDEBUG
+#define SOLVER_CHECK_STEPS_DEFAULT false
+#else
+#define SOLVER_CHECK_STEPS_DEFAULT true
+#endif
+
 typedef enum {
     SOLVE_ONGOING,
     SOLVE_COMPLETE,
-    SOLVE_STUCK
+    SOLVE_STUCK,
+    SOLVE_INVALID,
+    SOLVE_TIMED_OUT,
+    SOLVE_BAD_STEP
 } SolveStatus;
 
+extern bool solver_check_steps;
+
+char *solve_status_name(SolveStatus status);
 SolveStatus solver_next_step(Grid *grid, Step *step);
+int solver_all_steps(Grid *grid, Steps *out);
 void solver_apply_step(Grid *grid, Step *step);
 void solver_revert_step(Grid *grid, Step *step);
+bool solver_step_is_valid(Grid *grid, Step *step);
 
 #endif
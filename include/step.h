@@ -1,6 +1,9 @@
 #ifndef STEP_H
 #define STEP_H
 
+#include <stdbool.h>
+
+#include "bitboard.h"
 #include "cand_set.h"
 #include "grid.h"
 
@@ -20,6 +23,24 @@ typedef enum {
     TECH_FINNED_X_WING,
     TECH_FINNED_SWORDFISH,
     TECH_FINNED_JELLYFISH,
+    TECH_XY_WING,
+    TECH_XYZ_WING,
+    TECH_W_WING,
+    TECH_SIMPLE_COLORING,
+    TECH_MULTI_COLORING,
+    TECH_AIC,
+    TECH_SUE_DE_COQ,
+    TECH_ALS_XZ,
+    TECH_FORCING_CHAIN,
+    TECH_UNIQUE_RECTANGLE_1,
+    TECH_UNIQUE_RECTANGLE_2,
+    TECH_UNIQUE_RECTANGLE_3,
+    TECH_UNIQUE_RECTANGLE_4,
+    TECH_BUG_PLUS_1,
+    TECH_PATTERN_OVERLAY,
+    TECH_FRANKEN_FISH,
+    TECH_MUTANT_FISH,
+    TECH_GUESS,
 
     NUM_TECHNIQUES
 } TechniqueType;
@@ -88,34 +109,163 @@ typedef struct {
     int removal_unit_idx;
 } PointingSetStep;
 
-#define MAX_BASIC_FISH_SIZE 4
-#define MAX_BASIC_FISH_REMOVALS 20
+#define MAX_FISH_SIZE 4
 
+// Units are numbered as in SearchScope, type * 9 + index. cells holds value's
+// candidates in the base units, and fins the ones no cover unit reaches. Every
+// removal sees all the fins
 typedef struct {
-    int base_idxs[MAX_BASIC_FISH_SIZE];
-    int cover_idxs[MAX_BASIC_FISH_SIZE];
+    int base_units[MAX_FISH_SIZE];
+    int cover_units[MAX_FISH_SIZE];
     int size;
     int value;
-    int removal_idxs[MAX_BASIC_FISH_REMOVALS];
+    Bitboard cells;
+    Bitboard fins;
+    Bitboard removals;
+} FishStep;
+
+#define MAX_WING_REMOVALS MAX_COMMON_PEERS
+
+// XY- and XYZ-Wings are a pivot cell and two pincers that see it. A W-Wing has
+// no pivot. Its two cells, stored as the pincers, hold the same pair and are
+// joined by a strong link on link_value between link_idxs
+typedef struct {
+    int pivot_idx;
+    CandSet pivot_cands;
+    int pincer_idxs[2];
+    CandSet pincer_cands[2];
+    int link_idxs[2];
+    int link_value;
+    int value;
+    int removal_idxs[MAX_WING_REMOVALS];
     int num_removals;
-    UnitType unit_type;
-} BasicFishStep;
+} WingStep;
 
-#define MAX_FINNED_FISH_SIZE 4
-#define MAX_FINNED_FISH_REMOVALS 20 // I'm sure it's lower. Maybe 4?
-#define MAX_FINS 6                  // Could it be lower?
+#define MAX_COLOR_CLUSTERS 2
 
+// Cells holding value, split into the two colors of a cluster of conjugate
+// pairs. colors[2 * c] and colors[2 * c + 1] are the colors of cluster c.
+// Simple coloring uses one cluster. A trap removes value from the cells seeing
+// colors[0] and colors[1], or with two clusters, colors[1] and colors[3] since
+// colors[0] sees colors[2]. A wrap shows colors[0] is false and removes it
 typedef struct {
-    int base_idxs[MAX_FINNED_FISH_SIZE];
-    int cover_idxs[MAX_FINNED_FISH_SIZE];
-    int size;
     int value;
-    int removal_idxs[MAX_FINNED_FISH_REMOVALS];
+    Bitboard colors[2 * MAX_COLOR_CLUSTERS];
+    int num_clusters;
+    bool is_wrap;
+    Bitboard removals;
+} ColoringStep;
+
+#define MAX_CHAIN_NODES 64
+#define MAX_CHAIN_REMOVALS MAX_COMMON_PEERS
+
+// An alternating inference chain, as NODEs from links.h. Links go strong, weak,
+// strong and so on, so nodes[0] or nodes[num_nodes - 1] is true. Nodes fit in a
+// short, which keeps a chain no bigger than the largest fixed-size step
+typedef struct {
+    short nodes[MAX_CHAIN_NODES];
+    int num_nodes;
+    short removals[MAX_CHAIN_REMOVALS];
+    int num_removals;
+} ChainStep;
+
+_Static_assert(sizeof(ChainStep) <= sizeof(NakedSetStep),
+               "ChainStep would make every Step bigger");
+
+// Two almost locked sets joined by x, which every copy in one set sees in the
+// other. x must then be in one of them, so the sets hold every other common
+// digit between them, and value goes from the cells seeing all its copies
+typedef struct {
+    Bitboard cells[2];
+    CandSet cands[2];
+    int x;
+    int value;
+    Bitboard removals;
+} AlsXzStep;
+
+#define MAX_SUE_DE_COQ_REMOVALS 10
+
+// Empty cells where a box and a line cross, an almost locked set from the rest
+// of the line and one from the rest of the box, whose candidates don't meet.
+// The three hold as many digits as they have cells, so the line set's digits
+// go from the rest of the line and the box set's from the rest of the box
+typedef struct {
+    Bitboard cells[3];
+    CandSet cands[3];
+    int removal_idxs[MAX_SUE_DE_COQ_REMOVALS];
+    CandSet removed_cands[MAX_SUE_DE_COQ_REMOVALS];
     int num_removals;
-    int fin_idxs[MAX_FINS];
-    int num_fins;
-    UnitType unit_type;
-} FinnedFishStep;
+} SueDeCoqStep;
+
+#define MAX_FORCING_BRANCHES 3
+#define MAX_FORCING_NODES 64
+
+typedef enum {
+    FORCING_NISHIO,
+    FORCING_CELL,
+    FORCING_UNIT
+} ForcingKind;
+
+// Each branch assumes a candidate and follows the singles it forces. A nishio
+// has one branch, which ends in a conflict, so its candidate goes. Cell and
+// unit forcing chains have a branch for each candidate of a cell or each place
+// of a digit in unit, and all of them reach the same conclusion. nodes holds
+// the placements of each branch in turn, starting from its assumption. A
+// placement is stored as removing the cell's other candidates
+typedef struct {
+    ForcingKind kind;
+    int unit;
+    short nodes[MAX_FORCING_NODES];
+    unsigned char branch_lens[MAX_FORCING_BRANCHES];
+    int num_branches;
+    int conclusion;
+    bool is_placement;
+    CandSet removed_cands;
+    int conflict_idx;
+    int conflict_unit;
+    int conflict_digit;
+} ForcingStep;
+
+#define MAX_UR_SET_SIZE 3
+#define MAX_UR_REMOVALS MAX_COMMON_PEERS
+
+// The rectangle is given by two opposite corners, and the other two follow.
+// cands is the pair that would make it a deadly pattern. In type 3 the extra
+// candidates of two corners act as one cell, which forms a naked set with
+// set_cells on set_cands
+typedef struct {
+    int corners[2];
+    CandSet cands;
+    Bitboard set_cells;
+    CandSet set_cands;
+    int removal_idxs[MAX_UR_REMOVALS];
+    CandSet removed_cands[MAX_UR_REMOVALS];
+    int num_removals;
+} UniqueRectangleStep;
+
+// Every other empty cell is bivalue, so idx must be value, the candidate that
+// appears three times in its units. The rest of its candidates go
+typedef struct {
+    int idx;
+    int value;
+    CandSet removed_cands;
+} BugStep;
+
+// cells is where value can still go in some template, out of num_templates
+typedef struct {
+    int value;
+    int num_templates;
+    Bitboard cells;
+    Bitboard removals;
+} PatternOverlayStep;
+
+// Guessing any of removed_cands in idx ends in a conflict once depth guesses,
+// that one included, are nested
+typedef struct {
+    int idx;
+    CandSet removed_cands;
+    int depth;
+} GuessStep;
 
 typedef struct {
     TechniqueType tech;
@@ -125,8 +275,17 @@ typedef struct {
         NakedSetStep naked_set;
         HiddenSetStep hidden_set;
         PointingSetStep pointing_set;
-        BasicFishStep basic_fish;
-        FinnedFishStep finned_fish;
+        FishStep fish;
+        WingStep wing;
+        ColoringStep coloring;
+        ChainStep chain;
+        AlsXzStep als_xz;
+        SueDeCoqStep sue_de_coq;
+        ForcingStep forcing;
+        UniqueRectangleStep unique_rectangle;
+        BugStep bug;
+        PatternOverlayStep pattern_overlay;
+        GuessStep guess;
     } as;
 } Step;
 
@@ -0,0 +1,29 @@
+#ifndef STEP_EFFECTS_H
+#define STEP_EFFECTS_H
+
+#include <stdbool.h>
+
+#include "cand_set.h"
+
+#define MAX_STEP_EFFECTS 81
+
+// A cell a step fills with value or, when value is 0, the candidates it
+// removes from the cell
+typedef struct {
+    int idx;
+    int value;
+    CandSet cands;
+} StepEffect;
+
+// What a step decides, leaving out what follows from it, such as the peer
+// removals of a placement. Checking these is enough to catch a wrong step
+typedef struct {
+    StepEffect elems[MAX_STEP_EFFECTS];
+    int len;
+} StepEffects;
+
+void step_effects_place(StepEffects *effects, int idx, int value);
+void step_effects_remove(StepEffects *effects, int idx, CandSet cands);
+bool step_effects_match(StepEffects *effects, unsigned char solution[81]);
+
+#endif
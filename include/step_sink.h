@@ -0,0 +1,23 @@
+#ifndef STEP_SINK_H
+#define STEP_SINK_H
+
+#include <stdbool.h>
+
+#include "step.h"
+
+typedef struct StepSink StepSink;
+
+// Receives the steps found by a technique, in the order the search meets
+// them. emit returns false to stop the search. num_steps counts the steps
+// emitted so far
+struct StepSink {
+    bool (*emit)(StepSink *sink, Step *step);
+    void *data;
+    int num_steps;
+};
+
+StepSink step_sink_first(Step *out);
+StepSink step_sink_all(Steps *out);
+bool step_sink_emit(StepSink *sink, Step *step);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef AIC_H
+#define AIC_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool aic(Grid *grid, StepSink *sink);
+
+void aic_apply(Grid *grid, Step *step);
+void aic_revert(Grid *grid, Step *step);
+void aic_explain(DynStr *ds, Step *step);
+void aic_colorise(ColorPair colors[81][9], Step *step);
+void aic_encode(Bytes *out, Step *step);
+void aic_decode(Decoder *in, Step *step);
+void aic_effects(StepEffects *out, Step *step);
+
+#endif
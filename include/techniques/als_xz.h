@@ -0,0 +1,24 @@
+#ifndef ALS_XZ_H
+#define ALS_XZ_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool als_xz(Grid *grid, StepSink *sink);
+
+void als_xz_apply(Grid *grid, Step *step);
+void als_xz_revert(Grid *grid, Step *step);
+void als_xz_explain(DynStr *ds, Step *step);
+void als_xz_colorise(ColorPair colors[81][9], Step *step);
+void als_xz_encode(Bytes *out, Step *step);
+void als_xz_decode(Decoder *in, Step *step);
+void als_xz_effects(StepEffects *out, Step *step);
+
+#endif
@@ -1,8 +1,13 @@
 #ifndef BACKTRACK_H
 #define BACKTRACK_H
 
+#include "cancel.h"
 #include "grid.h"
 
-int backtrack(Grid *grid);
+#define BACKTRACK_CANCELLED -1
+
+int backtrack(Grid *grid, unsigned char out_solution[81]);
+int backtrack_values(int values[81], unsigned char out_solution[81],
+                     CancelToken *cancel);
 
 #endif
@@ -0,0 +1,24 @@
+#ifndef BUG_H
+#define BUG_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool bug_plus_1(Grid *grid, StepSink *sink);
+
+void bug_apply(Grid *grid, Step *step);
+void bug_revert(Grid *grid, Step *step);
+void bug_explain(DynStr *ds, Step *step);
+void bug_colorise(ColorPair colors[81][9], Step *step);
+void bug_encode(Bytes *out, Step *step);
+void bug_decode(Decoder *in, Step *step);
+void bug_effects(StepEffects *out, Step *step);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef COLORING_H
+#define COLORING_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool simple_coloring(Grid *grid, StepSink *sink);
+bool multi_coloring(Grid *grid, StepSink *sink);
+
+void coloring_apply(Grid *grid, Step *step);
+void coloring_revert(Grid *grid, Step *step);
+void coloring_explain(DynStr *ds, Step *step);
+void coloring_colorise(ColorPair colors[81][9], Step *step);
+void coloring_encode(Bytes *out, Step *step);
+void coloring_decode(Decoder *in, Step *step);
+void coloring_effects(StepEffects *out, Step *step);
+
+#endif
@@ -7,7 +7,7 @@
 #define UNIT_TO_STR(u) \
     ((u) == UNIT_ROW ? "Row" : (u) == UNIT_COL ? "Column" : "Box")
 #define UNIT_TO_STR_PLURAL(u) \
-    ((u) == UNIT_ROW ? "Rows" : (u) == UNIT_COL ? "Columns" : "Boxs")
+    ((u) == UNIT_ROW ? "Rows" : (u) == UNIT_COL ? "Columns" : "Boxes")
 #define SET_NAME_FROM_SIZE(n) ((n) == 2 ? "Pair" : (n) == 3 ? "Triple" : "Quad")
 #define FISH_NAME_FROM_SIZE(n) \
     ((n) == 2 ? "X-Wing" : (n) == 3 ? "Swordfish" : "Jellyfish")
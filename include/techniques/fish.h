@@ -0,0 +1,31 @@
+#ifndef FISH_H
+#define FISH_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool x_wing(Grid *grid, StepSink *sink);
+bool swordfish(Grid *grid, StepSink *sink);
+bool jellyfish(Grid *grid, StepSink *sink);
+bool finned_x_wing(Grid *grid, StepSink *sink);
+bool finned_swordfish(Grid *grid, StepSink *sink);
+bool finned_jellyfish(Grid *grid, StepSink *sink);
+bool franken_fish(Grid *grid, StepSink *sink);
+bool mutant_fish(Grid *grid, StepSink *sink);
+
+void fish_apply(Grid *grid, Step *step);
+void fish_revert(Grid *grid, Step *step);
+void fish_explain(DynStr *ds, Step *step);
+void fish_colorise(ColorPair colors[81][9], Step *step);
+void fish_encode(Bytes *out, Step *step);
+void fish_decode(Decoder *in, Step *step);
+void fish_effects(StepEffects *out, Step *step);
+
+#endif
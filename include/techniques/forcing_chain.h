@@ -0,0 +1,24 @@
+#ifndef FORCING_CHAIN_H
+#define FORCING_CHAIN_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool forcing_chain(Grid *grid, StepSink *sink);
+
+void forcing_chain_apply(Grid *grid, Step *step);
+void forcing_chain_revert(Grid *grid, Step *step);
+void forcing_chain_explain(DynStr *ds, Step *step);
+void forcing_chain_colorise(ColorPair colors[81][9], Step *step);
+void forcing_chain_encode(Bytes *out, Step *step);
+void forcing_chain_decode(Decoder *in, Step *step);
+void forcing_chain_effects(StepEffects *out, Step *step);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef GUESS_H
+#define GUESS_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+// Guessing is off unless asked for with --guess-depth. Each extra guess
+// doubles the work on bivalue cells. A depth of 8 keeps a call within
+// milliseconds and is enough for the hardest known puzzles
+#define GUESS_MAX_DEPTH_DEFAULT 0
+
+extern int guess_max_depth;
+
+bool guess(Grid *grid, StepSink *sink);
+
+void guess_apply(Grid *grid, Step *step);
+void guess_revert(Grid *grid, Step *step);
+void guess_explain(DynStr *ds, Step *step);
+void guess_colorise(ColorPair colors[81][9], Step *step);
+void guess_encode(Bytes *out, Step *step);
+void guess_decode(Decoder *in, Step *step);
+void guess_effects(StepEffects *out, Step *step);
+
+#endif
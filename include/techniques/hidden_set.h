@@ -3,19 +3,25 @@
 
 #include <stdbool.h>
 
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 
-bool hidden_set(Grid *grid, Step *step);
-bool hidden_pair(Grid *grid, Step *step);
-bool hidden_triple(Grid *grid, Step *step);
-bool hidden_quad(Grid *grid, Step *step);
+bool hidden_set(Grid *grid, StepSink *sink);
+bool hidden_pair(Grid *grid, StepSink *sink);
+bool hidden_triple(Grid *grid, StepSink *sink);
+bool hidden_quad(Grid *grid, StepSink *sink);
 
 void hidden_set_apply(Grid *grid, Step *step);
 void hidden_set_revert(Grid *grid, Step *step);
 void hidden_set_explain(DynStr *ds, Step *step);
 void hidden_set_colorise(ColorPair colors[81][9], Step *step);
+void hidden_set_encode(Bytes *out, Step *step);
+void hidden_set_decode(Decoder *in, Step *step);
+void hidden_set_effects(StepEffects *out, Step *step);
 
 #endif
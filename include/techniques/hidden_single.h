@@ -3,16 +3,22 @@
 
 #include <stdbool.h>
 
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 
-bool hidden_single(Grid *grid, Step *step);
+bool hidden_single(Grid *grid, StepSink *sink);
 
 void hidden_single_apply(Grid *grid, Step *step);
 void hidden_single_revert(Grid *grid, Step *step);
 void hidden_single_explain(DynStr *ds, Step *step);
 void hidden_single_colorise(ColorPair colors[81][9], Step *step);
+void hidden_single_encode(Bytes *out, Step *step);
+void hidden_single_decode(Decoder *in, Step *step);
+void hidden_single_effects(StepEffects *out, Step *step);
 
 #endif
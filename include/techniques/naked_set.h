@@ -3,19 +3,25 @@
 
 #include <stdbool.h>
 
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 
-bool naked_set(Grid *grid, Step *step);
-bool naked_pair(Grid *grid, Step *step);
-bool naked_triple(Grid *grid, Step *step);
-bool naked_quad(Grid *grid, Step *step);
+bool naked_set(Grid *grid, StepSink *sink);
+bool naked_pair(Grid *grid, StepSink *sink);
+bool naked_triple(Grid *grid, StepSink *sink);
+bool naked_quad(Grid *grid, StepSink *sink);
 
 void naked_set_apply(Grid *grid, Step *step);
 void naked_set_revert(Grid *grid, Step *step);
 void naked_set_explain(DynStr *ds, Step *step);
 void naked_set_colorise(ColorPair colors[81][9], Step *step);
+void naked_set_encode(Bytes *out, Step *step);
+void naked_set_decode(Decoder *in, Step *step);
+void naked_set_effects(StepEffects *out, Step *step);
 
 #endif
@@ -0,0 +1,24 @@
+#ifndef PATTERN_OVERLAY_H
+#define PATTERN_OVERLAY_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool pattern_overlay(Grid *grid, StepSink *sink);
+
+void pattern_overlay_apply(Grid *grid, Step *step);
+void pattern_overlay_revert(Grid *grid, Step *step);
+void pattern_overlay_explain(DynStr *ds, Step *step);
+void pattern_overlay_colorise(ColorPair colors[81][9], Step *step);
+void pattern_overlay_encode(Bytes *out, Step *step);
+void pattern_overlay_decode(Decoder *in, Step *step);
+void pattern_overlay_effects(StepEffects *out, Step *step);
+
+#endif
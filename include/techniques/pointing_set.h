@@ -3,16 +3,22 @@
 
 #include <stdbool.h>
 
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 
-bool pointing_set(Grid *grid, Step *step);
+bool pointing_set(Grid *grid, StepSink *sink);
 
 void pointing_set_apply(Grid *grid, Step *step);
 void pointing_set_revert(Grid *grid, Step *step);
 void pointing_set_explain(DynStr *ds, Step *step);
 void pointing_set_colorise(ColorPair colors[81][9], Step *step);
+void pointing_set_encode(Bytes *out, Step *step);
+void pointing_set_decode(Decoder *in, Step *step);
+void pointing_set_effects(StepEffects *out, Step *step);
 
 #endif
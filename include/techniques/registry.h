@@ -3,21 +3,50 @@
 
 #include <stdbool.h>
 
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 
-typedef bool (*TechniqueFn)(Grid *, Step *);
+// Emits every step the technique finds to the sink. Returns false if the sink
+// stopped the search early
+typedef bool (*TechniqueFn)(Grid *, StepSink *);
+
+// What a technique's result depends on, besides the digits and units it's
+// limited to by the grid's search scope. A technique that failed can only
+// succeed again once one of those changes
+typedef enum {
+    DEPS_GRID,
+    DEPS_DIGITS,
+    DEPS_UNITS,
+    DEPS_UNITS_AND_CROSSINGS,
+} TechniqueDeps;
+
+typedef struct {
+    TechniqueFn find_all;
+    TechniqueType tech;
+    TechniqueDeps deps;
+} Technique;
 
 typedef struct {
     void (*apply)(Grid *, Step *);
     void (*revert)(Grid *, Step *);
     void (*explain)(DynStr *, Step *);
     void (*colorise)(ColorPair[81][9], Step *);
+    void (*encode)(Bytes *, Step *);
+    void (*decode)(Decoder *, Step *);
+    void (*effects)(StepEffects *, Step *);
 } TechniqueOps;
 
-extern TechniqueFn techniques[];
+extern Technique techniques[];
 extern TechniqueOps technique_ops[];
+extern char *technique_names[];
+
+bool technique_find(Technique *tech, Grid *grid, Step *out);
+int technique_from_name(char *name);
+int technique_from_full_name(char *name);
 
 #endif
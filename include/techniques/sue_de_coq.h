@@ -0,0 +1,24 @@
+#ifndef SUE_DE_COQ_H
+#define SUE_DE_COQ_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool sue_de_coq(Grid *grid, StepSink *sink);
+
+void sue_de_coq_apply(Grid *grid, Step *step);
+void sue_de_coq_revert(Grid *grid, Step *step);
+void sue_de_coq_explain(DynStr *ds, Step *step);
+void sue_de_coq_colorise(ColorPair colors[81][9], Step *step);
+void sue_de_coq_encode(Bytes *out, Step *step);
+void sue_de_coq_decode(Decoder *in, Step *step);
+void sue_de_coq_effects(StepEffects *out, Step *step);
+
+#endif
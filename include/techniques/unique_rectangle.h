@@ -0,0 +1,27 @@
+#ifndef UNIQUE_RECTANGLE_H
+#define UNIQUE_RECTANGLE_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool unique_rectangle_1(Grid *grid, StepSink *sink);
+bool unique_rectangle_2(Grid *grid, StepSink *sink);
+bool unique_rectangle_3(Grid *grid, StepSink *sink);
+bool unique_rectangle_4(Grid *grid, StepSink *sink);
+
+void unique_rectangle_apply(Grid *grid, Step *step);
+void unique_rectangle_revert(Grid *grid, Step *step);
+void unique_rectangle_explain(DynStr *ds, Step *step);
+void unique_rectangle_colorise(ColorPair colors[81][9], Step *step);
+void unique_rectangle_encode(Bytes *out, Step *step);
+void unique_rectangle_decode(Decoder *in, Step *step);
+void unique_rectangle_effects(StepEffects *out, Step *step);
+
+#endif
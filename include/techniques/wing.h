@@ -0,0 +1,26 @@
+#ifndef WING_H
+#define WING_H
+
+#include <stdbool.h>
+
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+bool xy_wing(Grid *grid, StepSink *sink);
+bool xyz_wing(Grid *grid, StepSink *sink);
+bool w_wing(Grid *grid, StepSink *sink);
+
+void wing_apply(Grid *grid, Step *step);
+void wing_revert(Grid *grid, Step *step);
+void wing_explain(DynStr *ds, Step *step);
+void wing_colorise(ColorPair colors[81][9], Step *step);
+void wing_encode(Bytes *out, Step *step);
+void wing_decode(Decoder *in, Step *step);
+void wing_effects(StepEffects *out, Step *step);
+
+#endif
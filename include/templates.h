@@ -0,0 +1,32 @@
+#ifndef TEMPLATES_H
+#define TEMPLATES_H
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cell.h"
+
+// Every way to place one digit nine times, one per row, column and box. A
+// template is the set of its nine cells
+#define NUM_TEMPLATES 46656
+#define TEMPLATE_WORDS (NUM_TEMPLATES / 64)
+
+// The templates each digit can still take: bit t of survivors[digit - 1] is
+// set when template t covers every cell holding the digit and no cell without
+// it as a candidate. possible is the union of those templates. allowed and
+// placed are what they were last filtered against, so templates_update only
+// redoes the digits that changed, and only rescans the whole table when a
+// digit gained a place
+typedef struct {
+    unsigned long long survivors[9][TEMPLATE_WORDS];
+    int num_survivors[9];
+    Bitboard allowed[9];
+    Bitboard placed[9];
+    Bitboard possible[9];
+    bool is_built;
+} TemplateIndex;
+
+void templates_init(TemplateIndex *index);
+void templates_update(TemplateIndex *index, Cell cells[81]);
+
+#endif
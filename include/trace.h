@@ -0,0 +1,46 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "grid.h"
+#include "history.h"
+#include "solver.h"
+#include "step.h"
+
+typedef struct {
+    long *elems;
+    int len;
+    int cap;
+} TraceIndex;
+
+typedef struct {
+    FILE *file;
+    TraceIndex index;
+} TraceWriter;
+
+// records_end is where the puzzle records stop and the index starts. Nothing
+// read from a record goes past it
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t records_end;
+    int num_puzzles;
+} TraceReader;
+
+bool trace_writer_open(TraceWriter *writer, char *path);
+bool trace_writer_add(TraceWriter *writer, char *grid_str, SolveStatus status,
+                      History *hist);
+bool trace_writer_close(TraceWriter *writer);
+
+bool trace_reader_open(TraceReader *reader, char *path);
+void trace_reader_close(TraceReader *reader);
+bool trace_reader_check(TraceReader *reader, int puzzle);
+Grid *trace_reader_grid(TraceReader *reader, int puzzle);
+SolveStatus trace_reader_status(TraceReader *reader, int puzzle);
+int trace_reader_num_steps(TraceReader *reader, int puzzle);
+Step *trace_reader_step(TraceReader *reader, int puzzle, int i, Step *out);
+
+#endif
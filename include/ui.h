@@ -6,53 +6,68 @@
 #define NCURSES_WIDECHAR 1
 #include <ncurses.h>
 
-#include "dynstr.h"
+#include "explanation.h"
 #include "grid.h"
 #include "step.h"
 
-typedef struct {
-    int start;
-    int len;
-} Line;
+typedef enum {
+    CP_DEFAULT,
+    CP_CLUE,
+    CP_REMOVAL,
+    CP_TRIGGER,
+    CP_SPECIAL,
+} ColorPair;
 
+// What each cell looked like when the grid was last drawn, so that only the
+// cells that changed since then are redrawn
 typedef struct {
-    Line *elems;
-    int len;
-    int cap;
-} Lines;
+    bool is_drawn;
+    int values[81];
+    unsigned int cands[81];
+    ColorPair colors[81][9];
+} GridShadow;
 
 typedef struct {
     WINDOW *grid_win;
     WINDOW *info_win;
     WINDOW *scroll_win;
-    DynStr info_buf;
-    Lines lines;
+    WINDOW *status_win;
+    WINDOW *list_win;
+    int list_top;
+    Explanation message;
+    Explanation *info;
     int curr_line;
+    GridShadow shadow;
 } Ui;
 
 typedef enum {
-    CP_DEFAULT,
-    CP_CLUE,
-    CP_REMOVAL,
-    CP_TRIGGER,
-    CP_SPECIAL,
-} ColorPair;
-
-typedef enum {
+    ACTION_NONE,
     ACTION_QUIT,
     ACTION_PREV,
     ACTION_NEXT,
     ACTION_SCROLL_UP,
     ACTION_SCROLL_DOWN,
+    ACTION_FIRST,
+    ACTION_LAST,
+    ACTION_PREV_SAME_TECH,
+    ACTION_NEXT_SAME_TECH,
+    ACTION_FIND_TECH,
+    ACTION_GOTO,
 } InputAction;
 
 void ui_init(Ui *ui);
 void ui_deinit(Ui *ui);
 void ui_print_message(Ui *ui, char *format, ...)
     __attribute__((format(printf, 2, 3)));
+void ui_print_status(Ui *ui, char *format, ...)
+    __attribute__((format(printf, 2, 3)));
 void ui_print_grid(Ui *ui, Grid *grid, Step *step);
 void ui_print_step(Ui *ui, Step *step);
+void ui_print_explanation(Ui *ui, Explanation *exp);
 void ui_scroll(Ui *ui, int delta);
-InputAction ui_wait_for_input(void);
+void ui_print_list(Ui *ui, char **rows, int num_rows, int selected);
+void ui_hide_list(Ui *ui);
+InputAction ui_wait_for_input(int *out_count);
+bool ui_prompt(Ui *ui, char *prompt, char *out, int max_len);
 
 #endif
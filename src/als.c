@@ -0,0 +1,156 @@
+#include "als.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "bits.h"
+#include "cell.h"
+#include "dynarr.h"
+
+static void als_update_unit(AlsIndex *index, int unit);
+static bool is_in_line(int unit, int set);
+
+void als_init(AlsIndex *index) {
+    index->is_built = false;
+}
+
+// Brings the sets up to date with cells. A unit is only rebuilt when one of its
+// cells changed
+void als_update(AlsIndex *index, Cell cells[81]) {
+    bool dirty[27] = {false};
+
+    for (int idx = 0; idx < 81; idx++) {
+        unsigned int cands = cells[idx].cands.cands;
+        if (index->is_built && cands == index->cands[idx]) continue;
+
+        index->cands[idx] = cands;
+        dirty[ROW_FROM_IDX(idx)] = true;
+        dirty[9 + COL_FROM_IDX(idx)] = true;
+        dirty[18 + BOX_FROM_IDX(idx)] = true;
+    }
+
+    for (int unit = 0; unit < 27; unit++) {
+        if (dirty[unit]) {
+            als_update_unit(index, unit);
+        }
+    }
+
+    index->is_built = true;
+}
+
+// Stores the sets of unit that lie within the positions in the mask within.
+// Returns how many there are
+int als_unit_sets(AlsIndex *index, int unit, int within,
+                  int out[NUM_UNIT_SETS]) {
+    int count = 0;
+    for (int word = 0; word < NUM_UNIT_SETS / 64; word++) {
+        unsigned long long bits = index->is_als[unit][word];
+        while (bits) {
+            int set = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if ((set & ~within) == 0) {
+                out[count++] = set;
+            }
+        }
+    }
+    return count;
+}
+
+unsigned int als_set_cands(AlsIndex *index, int unit, int set) {
+    unsigned int cands = 0;
+    for (int i = 0; i < 9; i++) {
+        if (IS_BIT_SET(set, i)) {
+            cands |= index->cands[IDX_FROM_UNIT(unit, i)];
+        }
+    }
+    return cands;
+}
+
+Bitboard als_set_cells(int unit, int set) {
+    Bitboard cells = bb_empty();
+    for (int i = 0; i < 9; i++) {
+        if (IS_BIT_SET(set, i)) {
+            bb_add(&cells, IDX_FROM_UNIT(unit, i));
+        }
+    }
+    return cells;
+}
+
+// Appends every set in the grid to out, each once. A set inside a box and a
+// line is in both units, so boxes skip the ones their rows and columns have
+void als_collect(AlsIndex *index, Bitboard peer_masks[81], Alses *out) {
+    int sets[NUM_UNIT_SETS];
+
+    for (int unit = 0; unit < 27; unit++) {
+        int num_sets = als_unit_sets(index, unit, ALL_POSITIONS, sets);
+
+        for (int i = 0; i < num_sets; i++) {
+            if (unit >= 18 && is_in_line(unit, sets[i])) continue;
+
+            Als als = {.cells = als_set_cells(unit, sets[i]),
+                       .cands = als_set_cands(index, unit, sets[i])};
+            for (int digit = 1; digit <= 9; digit++) {
+                als.cells_with[digit - 1] = bb_empty();
+                als.sees[digit - 1] = bb_empty();
+                if (!IS_BIT_SET(als.cands, digit - 1)) continue;
+
+                for (int j = 0; j < 9; j++) {
+                    int idx = IDX_FROM_UNIT(unit, j);
+                    if (!IS_BIT_SET(sets[i], j)) continue;
+                    if (!IS_BIT_SET(index->cands[idx], digit - 1)) continue;
+
+                    als.sees[digit - 1] =
+                        bb_is_empty(als.cells_with[digit - 1])
+                            ? peer_masks[idx]
+                            : bb_and(als.sees[digit - 1], peer_masks[idx]);
+                    bb_add(&als.cells_with[digit - 1], idx);
+                }
+            }
+            da_append(out, als);
+        }
+    }
+}
+
+// Unions of the cells' candidates are built up one cell at a time, each from
+// the union of the set without its lowest cell, so every subset costs one OR
+static void als_update_unit(AlsIndex *index, int unit) {
+    unsigned int unions[NUM_UNIT_SETS];
+    int empty = 0;
+
+    for (int i = 0; i < 9; i++) {
+        if (index->cands[IDX_FROM_UNIT(unit, i)] != 0) {
+            empty |= BIT(i);
+        }
+    }
+
+    memset(index->is_als[unit], 0, sizeof(index->is_als[unit]));
+    unions[0] = 0;
+    for (int set = 1; set < NUM_UNIT_SETS; set++) {
+        int low = __builtin_ctz(set);
+        unions[set] = unions[set & (set - 1)]
+                      | index->cands[IDX_FROM_UNIT(unit, low)];
+
+        if ((set & ~empty) != 0) continue;
+        if (__builtin_popcount(unions[set]) == __builtin_popcount(set) + 1) {
+            index->is_als[unit][set / 64] |= 1ull << (set % 64);
+        }
+    }
+}
+
+// Whether the positions in set of a box all lie in one row or column
+static bool is_in_line(int unit, int set) {
+    int box = unit - 18;
+    int first = IDX_FROM_BOX_POSITION(box, __builtin_ctz(set));
+    bool same_row = true;
+    bool same_col = true;
+
+    for (int i = 0; i < 9; i++) {
+        if (!IS_BIT_SET(set, i)) continue;
+        int idx = IDX_FROM_BOX_POSITION(box, i);
+        same_row = same_row && ROW_FROM_IDX(idx) == ROW_FROM_IDX(first);
+        same_col = same_col && COL_FROM_IDX(idx) == COL_FROM_IDX(first);
+    }
+
+    return same_row || same_col;
+}
@@ -0,0 +1,188 @@
+#include "batch.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cancel.h"
+#include "grid.h"
+#include "explanation.h"
+#include "history.h"
+#include "rating.h"
+#include "scheduler.h"
+#include "solver.h"
+#include "step.h"
+#include "trace.h"
+#include "techniques/backtrack.h"
+#include "techniques/registry.h"
+
+static void add_costs(TechniqueCost total[NUM_TECHNIQUES],
+                      TechniqueCost costs[NUM_TECHNIQUES]);
+static void print_costs(TechniqueCost costs[NUM_TECHNIQUES], Rating *rating);
+static void print_bad_step(History *hist);
+
+// Solves every puzzle in puzzles_path, one per line, printing a summary line
+// with its rating for each. If trace_path is not NULL, the full step traces
+// are saved there. Each puzzle gets budget_ns and max_steps before it's given
+// up on, where zero means no limit
+int batch_run(char *puzzles_path, char *trace_path, long long budget_ns,
+              int max_steps) {
+    FILE *puzzles = fopen(puzzles_path, "r");
+    if (!puzzles) {
+        fprintf(stderr, "Could not open %s\n", puzzles_path);
+        return 1;
+    }
+
+    TraceWriter writer;
+    if (trace_path && !trace_writer_open(&writer, trace_path)) {
+        fprintf(stderr, "Could not create %s\n", trace_path);
+        fclose(puzzles);
+        return 1;
+    }
+
+    int counts[SOLVE_BAD_STEP + 1] = {0};
+    TechniqueCost costs[NUM_TECHNIQUES] = {0};
+    Rating total;
+    rating_init(&total);
+    int num_puzzles = 0;
+    int num_guessed = 0;
+
+    char line[MAX_LINE_LEN];
+    while (batch_read_puzzle(puzzles, line)) {
+        Grid *grid = grid_create(line);
+        History hist = {0};
+
+        CancelToken cancel;
+        cancel_init(&cancel, budget_ns, max_steps);
+        grid->cancel = &cancel;
+
+        char grid_str[CANDS_STR_LEN + 1];
+        grid_to_cands_str(grid, grid_str);
+
+        Rating rating;
+        rating_init(&rating);
+
+        SolveStatus status = batch_solve(grid, &hist, costs, &rating);
+        counts[status]++;
+        rating_add(&total, &rating);
+
+        printf("%d %s %d %lld %s", num_puzzles, solve_status_name(status),
+               history_len(&hist), rating.score,
+               rating.hardest == -1 ? "-" : technique_names[rating.hardest]);
+        if (rating.guess_depth > 0) {
+            printf(" (guess depth %d)", rating.guess_depth);
+            num_guessed++;
+        }
+        printf("\n");
+
+        if (status == SOLVE_BAD_STEP) {
+            print_bad_step(&hist);
+        }
+        if (trace_path) {
+            trace_writer_add(&writer, grid_str, status, &hist);
+        }
+
+        history_free(&hist);
+        grid_destroy(grid);
+        num_puzzles++;
+    }
+
+    fclose(puzzles);
+
+    if (trace_path && !trace_writer_close(&writer)) {
+        fprintf(stderr, "Could not write %s\n", trace_path);
+        return 1;
+    }
+
+    fprintf(stderr,
+            "%d puzzles: %d solved, %d stuck, %d invalid, %d timed out, "
+            "%d bad steps, %d needing guesses\n",
+            num_puzzles, counts[SOLVE_COMPLETE], counts[SOLVE_STUCK],
+            counts[SOLVE_INVALID], counts[SOLVE_TIMED_OUT],
+            counts[SOLVE_BAD_STEP], num_guessed);
+    print_costs(costs, &total);
+
+    return 0;
+}
+
+static void add_costs(TechniqueCost total[NUM_TECHNIQUES],
+                      TechniqueCost costs[NUM_TECHNIQUES]) {
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        total[i].ns += costs[i].ns;
+        total[i].calls += costs[i].calls;
+        total[i].scoped += costs[i].scoped;
+    }
+}
+
+static void print_costs(TechniqueCost costs[NUM_TECHNIQUES], Rating *rating) {
+    fprintf(stderr, "%-23s %8s %8s %10s %8s\n", "Technique", "Calls",
+            "Scoped", "Time (ms)", "Steps");
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        TechniqueType tech = techniques[i].tech;
+        fprintf(stderr, "%-23s %8d %8d %10.2f %8d\n", technique_names[tech],
+                costs[i].calls, costs[i].scoped, costs[i].ns / 1e6,
+                rating->counts[tech]);
+    }
+}
+
+// The offending step is the last one in hist
+static void print_bad_step(History *hist) {
+    Explanation *exp = history_explanation(hist, history_len(hist) - 1);
+    fprintf(stderr, "Step contradicts the solution: %.*s", exp->text.len,
+            exp->text.elems);
+}
+
+// Reads the next puzzle line. Skips blank lines, comments starting with '#' and
+// lines too short to hold a grid
+bool batch_read_puzzle(FILE *file, char out[MAX_LINE_LEN]) {
+    while (fgets(out, MAX_LINE_LEN, file)) {
+        out[strcspn(out, "\r\n")] = '\0';
+
+        if (out[0] == '#') continue;
+        if (strncmp(out, "S9B", 3) == 0 && strlen(out) >= CANDS_STR_LEN) {
+            return true;
+        }
+        if (strncmp(out, "S9B", 3) != 0 && strlen(out) >= 81) return true;
+    }
+    return false;
+}
+
+// Checks that grid has a single solution and then records every step the
+// solver finds in hist, leaving grid in its final state. If costs is not NULL,
+// the time spent in each technique is added to it, and if rating is not NULL,
+// every step is rated. If the grid's cancel token fires, hist and grid are
+// left consistent with each other at the last step taken. A step that
+// contradicts the solution ends hist without being applied to grid
+SolveStatus batch_solve(Grid *grid, History *hist,
+                        TechniqueCost costs[NUM_TECHNIQUES], Rating *rating) {
+    int num_solutions = backtrack(grid, grid->solution);
+    if (num_solutions == BACKTRACK_CANCELLED) return SOLVE_TIMED_OUT;
+    if (num_solutions != 1) return SOLVE_INVALID;
+    grid->has_solution = true;
+
+    Scheduler sched;
+    scheduler_init(&sched);
+
+    while (true) {
+        Step step;
+        SolveStatus status = scheduler_next_step(&sched, grid, &step);
+
+        if (status == SOLVE_ONGOING && !solver_step_is_valid(grid, &step)) {
+            history_add(hist, &step);
+            status = SOLVE_BAD_STEP;
+        }
+        if (status == SOLVE_ONGOING && grid->cancel
+            && cancel_add_step(grid->cancel)) {
+            status = SOLVE_TIMED_OUT;
+        }
+
+        if (status != SOLVE_ONGOING) {
+            if (costs) add_costs(costs, sched.costs);
+            return status;
+        }
+
+        history_add(hist, &step);
+        solver_apply_step(grid, &step);
+        if (rating) rating_add_step(rating, &step);
+    }
+}
@@ -0,0 +1,40 @@
+#include "bitboard.h"
+
+#include <stdbool.h>
+
+Bitboard bb_empty(void) {
+    return (Bitboard){.lo = 0, .hi = 0};
+}
+
+bool bb_is_empty(Bitboard bb) {
+    return bb.lo == 0 && bb.hi == 0;
+}
+
+bool bb_equal(Bitboard a, Bitboard b) {
+    return a.lo == b.lo && a.hi == b.hi;
+}
+
+int bb_count(Bitboard bb) {
+    return __builtin_popcountll(bb.lo) + __builtin_popcountll(bb.hi);
+}
+
+Bitboard bb_and(Bitboard a, Bitboard b) {
+    return (Bitboard){.lo = a.lo & b.lo, .hi = a.hi & b.hi};
+}
+
+Bitboard bb_or(Bitboard a, Bitboard b) {
+    return (Bitboard){.lo = a.lo | b.lo, .hi = a.hi | b.hi};
+}
+
+Bitboard bb_and_not(Bitboard a, Bitboard b) {
+    return (Bitboard){.lo = a.lo & ~b.lo, .hi = a.hi & ~b.hi};
+}
+
+// Stores the cells in bb in increasing order. Returns how many there are
+int bb_to_idxs(Bitboard bb, int out[]) {
+    int count = 0;
+    for (int idx = bb_pop(&bb); idx != -1; idx = bb_pop(&bb)) {
+        out[count++] = idx;
+    }
+    return count;
+}
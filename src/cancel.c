@@ -0,0 +1,51 @@
+#include "cancel.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+
+void cancel_init(CancelToken *token, long long budget_ns, int max_steps) {
+    token->deadline_ns = budget_ns > 0 ? cancel_now_ns() + budget_ns : 0;
+    token->max_steps = max_steps;
+    token->num_steps = 0;
+    token->countdown = CANCEL_CHECK_INTERVAL;
+    atomic_init(&token->cancelled, false);
+}
+
+// Safe to call from any thread
+void cancel_request(CancelToken *token) {
+    atomic_store(&token->cancelled, true);
+}
+
+// Meant to be polled from inner loops. Reading the clock costs more than the
+// loop bodies it guards, so it is only read every CANCEL_CHECK_INTERVAL calls
+bool cancel_check(CancelToken *token) {
+    if (cancel_is_cancelled(token)) return true;
+    if (token->deadline_ns == 0 || --token->countdown > 0) return false;
+
+    token->countdown = CANCEL_CHECK_INTERVAL;
+    if (cancel_now_ns() < token->deadline_ns) return false;
+
+    cancel_request(token);
+    return true;
+}
+
+// Counts one solver step. Returns true if it goes over the step budget
+bool cancel_add_step(CancelToken *token) {
+    if (token->max_steps == 0) return cancel_is_cancelled(token);
+
+    if (++token->num_steps > token->max_steps) {
+        cancel_request(token);
+    }
+    return cancel_is_cancelled(token);
+}
+
+bool cancel_is_cancelled(CancelToken *token) {
+    return atomic_load_explicit(&token->cancelled, memory_order_relaxed);
+}
+
+long long cancel_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
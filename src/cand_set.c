@@ -24,7 +24,7 @@ CandSet cand_set_from_mask(unsigned int mask) {
 }
 
 CandSet cand_set_from_values(int num_values, ...) {
-    CandSet set;
+    CandSet set = cand_set_empty();
 
     va_list values;
     va_start(values, num_values);
@@ -5,21 +5,13 @@
 
 #include "cand_set.h"
 
-Cell *cell_create(int idx, int value, CandSet cands, bool is_clue) {
-    Cell *cell = malloc(sizeof(Cell));
-
+void cell_init(Cell *cell, int idx, int value, CandSet cands, bool is_clue) {
     cell->value = value;
     cell->cands = cands;
     cell->row = ROW_FROM_IDX(idx);
     cell->col = COL_FROM_IDX(idx);
     cell->box = BOX_FROM_IDX(idx);
     cell->is_clue = is_clue;
-
-    return cell;
-}
-
-void cell_destroy(Cell *cell) {
-    free(cell);
 }
 
 int cell_idx(Cell *cell) {
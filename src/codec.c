@@ -0,0 +1,140 @@
+#include "codec.h"
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cand_set.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "links.h"
+#include "step.h"
+#include "techniques/registry.h"
+
+// Every field of a step is a small non-negative integer, so they are written
+// as LEB128 varints: 7 bits per byte, with the high bit set on all but the last
+// byte. Cell indices and unit numbers always fit in a single byte. A u32 takes
+// at most 5 bytes
+#define MAX_VARINT_LEN 5
+
+int step_encode(Bytes *out, Step *step) {
+    int start = out->len;
+    encode_uint(out, step->tech);
+    technique_ops[step->tech].encode(out, step);
+    return out->len - start;
+}
+
+// Decodes a step from the size bytes at data. Returns the bytes it took, or -1
+// if they don't hold a whole, well-formed step
+int step_decode(unsigned char *data, int size, Step *out) {
+    Decoder in = {.pos = data, .end = data + size, .failed = false};
+    out->tech = decode_max(&in, NUM_TECHNIQUES - 1);
+    if (in.failed) return -1;
+
+    technique_ops[out->tech].decode(&in, out);
+    return in.failed ? -1 : in.pos - data;
+}
+
+// Returns NUM_TECHNIQUES if data doesn't start with a technique
+TechniqueType step_decode_tech(unsigned char *data, int size) {
+    Decoder in = {.pos = data, .end = data + size, .failed = false};
+    TechniqueType tech = decode_max(&in, NUM_TECHNIQUES - 1);
+    return in.failed ? NUM_TECHNIQUES : tech;
+}
+
+void encode_uint(Bytes *out, unsigned int value) {
+    while (value >= 0x80) {
+        da_append(out, (value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    da_append(out, value);
+}
+
+void encode_idxs(Bytes *out, int idxs[], int num_idxs) {
+    encode_uint(out, num_idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        encode_uint(out, idxs[i]);
+    }
+}
+
+void encode_cand_set(Bytes *out, CandSet set) {
+    encode_uint(out, set.cands);
+}
+
+// Written as its cells, which is shorter than the 81 bits for the few cells a
+// step usually holds
+void encode_bitboard(Bytes *out, Bitboard bb) {
+    int idxs[81];
+    int num_idxs = bb_to_idxs(bb, idxs);
+    encode_idxs(out, idxs, num_idxs);
+}
+
+void encode_unit(Bytes *out, UnitType unit_type, int unit_idx) {
+    encode_uint(out, unit_type * 9 + unit_idx);
+}
+
+unsigned int decode_uint(Decoder *in) {
+    unsigned int value = 0;
+    for (int i = 0; i < MAX_VARINT_LEN && in->pos < in->end; i++) {
+        unsigned char byte = *in->pos++;
+        value |= (unsigned int)(byte & 0x7f) << (i * 7);
+        if (!(byte & 0x80)) return value;
+    }
+
+    in->failed = true;
+    return 0;
+}
+
+unsigned int decode_max(Decoder *in, unsigned int max) {
+    unsigned int value = decode_uint(in);
+    if (value <= max) return value;
+
+    in->failed = true;
+    return 0;
+}
+
+int decode_idx(Decoder *in) {
+    return decode_max(in, 80);
+}
+
+// Returns 1 rather than 0 on failure, so the step stays safe to display
+int decode_digit(Decoder *in) {
+    unsigned int digit = decode_max(in, 9);
+    if (digit >= 1) return digit;
+
+    in->failed = true;
+    return 1;
+}
+
+int decode_node(Decoder *in) {
+    return decode_max(in, NUM_NODES - 1);
+}
+
+// Decodes at most max_idxs cell indices into out
+int decode_idxs(Decoder *in, int out[], int max_idxs) {
+    int num_idxs = decode_max(in, max_idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        out[i] = decode_idx(in);
+    }
+    return num_idxs;
+}
+
+CandSet decode_cand_set(Decoder *in) {
+    return cand_set_from_mask(decode_max(in, 0x1ff));
+}
+
+Bitboard decode_bitboard(Decoder *in) {
+    int idxs[81];
+    int num_idxs = decode_idxs(in, idxs, 81);
+
+    Bitboard bb = bb_empty();
+    for (int i = 0; i < num_idxs; i++) {
+        bb_add(&bb, idxs[i]);
+    }
+    return bb;
+}
+
+void decode_unit(Decoder *in, UnitType *out_type, int *out_idx) {
+    int unit = decode_max(in, 26);
+    *out_type = unit / 9;
+    *out_idx = unit % 9;
+}
@@ -26,14 +26,20 @@ void ds_appendf(DynStr *ds, char *format, ...) {
     va_end(args);
 }
 
+// Formats straight into the spare capacity first, so the string is only
+// formatted a second time when it doesn't fit
 void ds_vappendf(DynStr *ds, char *format, va_list args) {
     va_list args1, args2;
     va_copy(args1, args);
     va_copy(args2, args);
 
-    int len = vsnprintf(NULL, 0, format, args1);
-    da_reserve(ds, ds->len + len + 1);
-    vsnprintf(ds->elems + ds->len, len + 1, format, args2);
+    da_reserve(ds, ds->len + 1);
+    int avail = ds->cap - ds->len;
+    int len = vsnprintf(ds->elems + ds->len, avail, format, args1);
+    if (len >= avail) {
+        da_reserve(ds, ds->len + len + 1);
+        vsnprintf(ds->elems + ds->len, len + 1, format, args2);
+    }
 
     va_end(args1);
     va_end(args2);
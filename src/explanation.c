@@ -0,0 +1,66 @@
+#include "explanation.h"
+
+#include <stdlib.h>
+
+#include "dynarr.h"
+#include "dynstr.h"
+#include "step.h"
+#include "techniques/registry.h"
+
+void explanation_init(Explanation *exp) {
+    ds_init(&exp->text);
+    da_init(&exp->lines);
+    exp->width = -1;
+}
+
+Explanation *explanation_create(Step *step) {
+    Explanation *exp = malloc(sizeof(Explanation));
+    explanation_init(exp);
+    explanation_set_step(exp, step);
+    return exp;
+}
+
+void explanation_set_step(Explanation *exp, Step *step) {
+    ds_clear(&exp->text);
+    technique_ops[step->tech].explain(&exp->text, step);
+    explanation_invalidate(exp);
+}
+
+// Must be called after text is changed directly
+void explanation_invalidate(Explanation *exp) {
+    exp->width = -1;
+}
+
+void explanation_wrap(Explanation *exp, int width) {
+    if (exp->width == width) return;
+
+    int line_start = 0;
+    int line_len = 0;
+
+    da_clear(&exp->lines);
+    for (int i = 0; i < exp->text.len; i++) {
+        if (exp->text.elems[i] != '\n' && line_len != width) {
+            line_len++;
+            continue;
+        }
+
+        Line line = {.start = line_start, .len = line_len};
+        da_append(&exp->lines, line);
+
+        line_start = line_len == width ? i : i + 1;
+        line_len = 0;
+    }
+
+    exp->width = width;
+}
+
+void explanation_deinit(Explanation *exp) {
+    ds_deinit(&exp->text);
+    da_deinit(&exp->lines);
+}
+
+void explanation_destroy(Explanation *exp) {
+    if (!exp) return;
+    explanation_deinit(exp);
+    free(exp);
+}
@@ -4,33 +4,110 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "als.h"
+#include "bitboard.h"
+#include "bits.h"
+#include "cancel.h"
 #include "cand_set.h"
 #include "cell.h"
+#include "links.h"
+#include "templates.h"
 
-static Grid *grid_from_values(char *grid_str);
-static Grid *grid_from_cands(char *grid_str);
+static void grid_from_values(Grid *grid, char *grid_str);
+static void grid_from_cands(Grid *grid, char *grid_str);
 static CandSet grid_cell_initial_cands(Grid *grid, Cell *cell);
+static void grid_link_cells(Grid *grid);
 static void grid_generate_peers(Grid *grid);
 
 Grid *grid_create(char *grid_str) {
-    Grid *grid;
+    Grid *grid = malloc(sizeof(Grid));
+    grid_init(grid, grid_str);
+    return grid;
+}
+
+// Fills a caller-owned grid, so callers on a hot path can keep it on the
+// stack. It is released with grid_deinit
+void grid_init(Grid *grid, char *grid_str) {
+    grid_link_cells(grid);
+    grid->empty_cells = 81;
 
     if (strncmp(grid_str, "S9B", 3) == 0) {
-        grid = grid_from_cands(grid_str + 3);
+        grid_from_cands(grid, grid_str + 3);
     } else {
-        grid = grid_from_values(grid_str);
+        grid_from_values(grid, grid_str);
     }
 
     grid_generate_peers(grid);
+    grid->scope = (SearchScope){.digits = ALL_DIGITS, .units = ALL_UNITS};
+    grid->cancel = NULL;
+    grid->has_solution = false;
+    grid->links = NULL;
+    grid->als = NULL;
+    grid->templates = NULL;
+}
 
-    return grid;
+Grid *grid_clone(Grid *grid) {
+    Grid *clone = malloc(sizeof(Grid));
+
+    grid_link_cells(clone);
+    memcpy(clone->cell_data, grid->cell_data, sizeof(grid->cell_data));
+    clone->empty_cells = grid->empty_cells;
+    clone->scope = grid->scope;
+    clone->cancel = grid->cancel;
+    memcpy(clone->solution, grid->solution, sizeof(grid->solution));
+    clone->has_solution = grid->has_solution;
+    clone->links = NULL;
+    clone->als = NULL;
+    clone->templates = NULL;
+
+    grid_generate_peers(clone);
+
+    return clone;
+}
+
+// Frees what a grid from grid_init allocated, but not the grid itself
+void grid_deinit(Grid *grid) {
+    free(grid->links);
+    free(grid->als);
+    free(grid->templates);
 }
 
 void grid_destroy(Grid *grid) {
+    grid_deinit(grid);
+    free(grid);
+}
+
+// Writes the grid in the same S9B format accepted by grid_create
+void grid_to_cands_str(Grid *grid, char out[CANDS_STR_LEN + 1]) {
+    char *digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    memcpy(out, "S9B", 3);
     for (int i = 0; i < 81; i++) {
-        cell_destroy(grid->cells[i]);
+        Cell *cell = grid->cells[i];
+
+        int cell_bits;
+        if (cell->is_clue) {
+            cell_bits = cell->value;
+        } else if (!cell_is_empty(cell)) {
+            cell_bits = cell->value + 9;
+        } else {
+            cell_bits = cell->cands.cands + 18;
+        }
+
+        out[3 + i * 2] = digits[cell_bits / 36];
+        out[3 + i * 2 + 1] = digits[cell_bits % 36];
     }
-    free(grid);
+    out[CANDS_STR_LEN] = '\0';
+}
+
+void grid_snapshot(Grid *grid, GridSnapshot *out) {
+    memcpy(out->cell_data, grid->cell_data, sizeof(grid->cell_data));
+    out->empty_cells = grid->empty_cells;
+}
+
+void grid_restore(Grid *grid, GridSnapshot *snapshot) {
+    memcpy(grid->cell_data, snapshot->cell_data, sizeof(grid->cell_data));
+    grid->empty_cells = snapshot->empty_cells;
 }
 
 bool grid_is_solved(Grid *grid) {
@@ -66,20 +143,68 @@ int grid_common_peers(Grid *grid, Cell *cells[], int num_cells, Cell *out[]) {
     return count;
 }
 
-static Grid *grid_from_values(char *grid_str) {
-    Grid *grid = malloc(sizeof(Grid));
+bool grid_digit_in_scope(Grid *grid, int digit) {
+    return IS_BIT_SET(grid->scope.digits, digit - 1);
+}
 
-    grid->empty_cells = 81;
+bool grid_unit_in_scope(Grid *grid, UnitType unit_type, int unit_idx) {
+    return IS_BIT_SET(grid->scope.units, unit_type * 9 + unit_idx);
+}
+
+// Polled by long searches. A grid without a token is never cancelled
+bool grid_is_cancelled(Grid *grid) {
+    return grid->cancel != NULL && cancel_check(grid->cancel);
+}
 
+Bitboard grid_cells_with_cand(Grid *grid, int cand) {
+    Bitboard cells = bb_empty();
+    for (int i = 0; i < 81; i++) {
+        if (cell_has_cand(grid->cells[i], cand)) {
+            bb_add(&cells, i);
+        }
+    }
+    return cells;
+}
+
+// Returns the grid's link graph, brought up to date with its candidates
+LinkGraph *grid_links(Grid *grid) {
+    if (!grid->links) {
+        grid->links = malloc(sizeof(LinkGraph));
+        links_init(grid->links);
+    }
+    links_update(grid->links, grid->cell_data);
+    return grid->links;
+}
+
+// Returns the grid's almost locked sets, brought up to date with its
+// candidates
+AlsIndex *grid_als(Grid *grid) {
+    if (!grid->als) {
+        grid->als = malloc(sizeof(AlsIndex));
+        als_init(grid->als);
+    }
+    als_update(grid->als, grid->cell_data);
+    return grid->als;
+}
+
+// Returns the grid's surviving templates, brought up to date with its
+// candidates
+TemplateIndex *grid_templates(Grid *grid) {
+    if (!grid->templates) {
+        grid->templates = malloc(sizeof(TemplateIndex));
+        templates_init(grid->templates);
+    }
+    templates_update(grid->templates, grid->cell_data);
+    return grid->templates;
+}
+
+static void grid_from_values(Grid *grid, char *grid_str) {
     for (int i = 0; i < 81; i++) {
         char c = grid_str[i];
         int value = c >= '1' && c <= '9' ? c - '0' : 0;
 
-        Cell *cell = cell_create(i, value, cand_set_empty(), value != 0);
-
-        grid->rows[cell->row][cell->col] = cell;
-        grid->cols[cell->col][cell->row] = cell;
-        grid->boxes[cell->box][BOX_POSITION_FROM_IDX(i)] = cell;
+        Cell *cell = grid->cells[i];
+        cell_init(cell, i, value, cand_set_empty(), value != 0);
 
         if (!cell_is_empty(cell)) {
             grid->empty_cells--;
@@ -92,17 +217,11 @@ static Grid *grid_from_values(char *grid_str) {
             cell->cands = grid_cell_initial_cands(grid, cell);
         }
     }
-
-    return grid;
 }
 
 // The encoding format is defined here:
 // https://www.sudokuwiki.org/Sudoku_String_Definitions
-static Grid *grid_from_cands(char *grid_str) {
-    Grid *grid = malloc(sizeof(Grid));
-
-    grid->empty_cells = 81;
-
+static void grid_from_cands(Grid *grid, char *grid_str) {
     for (int i = 0; i < 81; i++) {
         char cell_str[3] = {grid_str[i * 2], grid_str[i * 2 + 1], '\0'};
         unsigned long cell_bits = strtoul(cell_str, NULL, 36);
@@ -125,18 +244,13 @@ static Grid *grid_from_cands(char *grid_str) {
             is_clue = false;
         }
 
-        Cell *cell = cell_create(i, value, cands, is_clue);
-
-        grid->rows[cell->row][cell->col] = cell;
-        grid->cols[cell->col][cell->row] = cell;
-        grid->boxes[cell->box][BOX_POSITION_FROM_IDX(i)] = cell;
+        Cell *cell = grid->cells[i];
+        cell_init(cell, i, value, cands, is_clue);
 
         if (!cell_is_empty(cell)) {
             grid->empty_cells--;
         }
     }
-
-    return grid;
 }
 
 static CandSet grid_cell_initial_cands(Grid *grid, Cell *cell) {
@@ -151,6 +265,19 @@ static CandSet grid_cell_initial_cands(Grid *grid, Cell *cell) {
         3, row_missing_values, col_missing_values, box_missing_values);
 }
 
+static void grid_link_cells(Grid *grid) {
+    for (int i = 0; i < 81; i++) {
+        Cell *cell = &grid->cell_data[i];
+        int row = ROW_FROM_IDX(i);
+        int col = COL_FROM_IDX(i);
+        int box = BOX_FROM_IDX(i);
+
+        grid->rows[row][col] = cell;
+        grid->cols[col][row] = cell;
+        grid->boxes[box][BOX_POSITION_FROM_IDX(i)] = cell;
+    }
+}
+
 static void grid_generate_peers(Grid *grid) {
     for (int i = 0; i < 81; i++) {
         int count = 0;
@@ -160,4 +287,18 @@ static void grid_generate_peers(Grid *grid) {
             }
         }
     }
+
+    for (int i = 0; i < 81; i++) {
+        grid->peer_masks[i] = bb_empty();
+        for (int j = 0; j < NUM_PEERS; j++) {
+            bb_add(&grid->peer_masks[i], cell_idx(grid->peers[i][j]));
+        }
+    }
+
+    for (int unit = 0; unit < 27; unit++) {
+        grid->unit_masks[unit] = bb_empty();
+        for (int i = 0; i < 9; i++) {
+            bb_add(&grid->unit_masks[unit], IDX_FROM_UNIT(unit, i));
+        }
+    }
 }
@@ -0,0 +1,141 @@
+#include "hint.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "cancel.h"
+#include "cell.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "techniques/backtrack.h"
+#include "techniques/registry.h"
+
+static HintStatus find_hint(Grid *grid, Hint *out);
+static bool is_hint_technique(TechniqueType tech);
+static bool is_valid_grid_str(char *grid_str);
+static int solve_clues(Grid *grid, unsigned char out_solution[81]);
+static bool find_mistakes(Grid *grid, unsigned char solution[81], Hint *out);
+
+void hint_init(Hint *hint) {
+    ds_init(&hint->explanation);
+    hint->num_mistakes = 0;
+}
+
+char *hint_status_name(HintStatus status) {
+    switch (status) {
+    case HINT_FOUND: return "Found";
+    case HINT_MISTAKES: return "Mistakes";
+    case HINT_SOLVED: return "Solved";
+    case HINT_STUCK: return "Stuck";
+    case HINT_TIMED_OUT: return "Timed out";
+    case HINT_INVALID: return "Invalid";
+    }
+    return "Unknown";
+}
+
+// Finds the easiest step for a grid entered by a user, either as plain values
+// or as an S9B string with their pencil marks. The marks are checked against
+// the solution first, since searching a grid that has lost a solution digit
+// would give a wrong hint. Techniques are then tried easiest first until one
+// finds a step, leaving out those too slow for a hint. budget_ns covers the
+// whole call, solving included. The grid lives on the stack, so nothing is
+// allocated apart from the explanation text and the caches of the techniques
+// that get to run
+HintStatus hint_find(char *grid_str, long long budget_ns, Hint *out) {
+    CancelToken cancel;
+    cancel_init(&cancel, budget_ns, 0);
+
+    ds_clear(&out->explanation);
+    out->num_mistakes = 0;
+
+    if (!is_valid_grid_str(grid_str)) return HINT_INVALID;
+
+    Grid grid;
+    grid_init(&grid, grid_str);
+    grid.cancel = &cancel;
+
+    HintStatus status = find_hint(&grid, out);
+    grid_deinit(&grid);
+    return status;
+}
+
+void hint_deinit(Hint *hint) {
+    ds_deinit(&hint->explanation);
+}
+
+static HintStatus find_hint(Grid *grid, Hint *out) {
+    unsigned char solution[81];
+    int num_solutions = solve_clues(grid, solution);
+    if (num_solutions == BACKTRACK_CANCELLED) return HINT_TIMED_OUT;
+    if (num_solutions != 1) return HINT_INVALID;
+    if (find_mistakes(grid, solution, out)) return HINT_MISTAKES;
+    memcpy(grid->solution, solution, sizeof(grid->solution));
+    grid->has_solution = true;
+
+    if (grid_is_solved(grid)) return HINT_SOLVED;
+
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        if (!is_hint_technique(techniques[i].tech)) continue;
+        if (grid_is_cancelled(grid)) return HINT_TIMED_OUT;
+
+        if (technique_find(&techniques[i], grid, &out->step)) {
+            technique_ops[out->step.tech].explain(&out->explanation,
+                                                  &out->step);
+            return HINT_FOUND;
+        }
+    }
+
+    return grid_is_cancelled(grid) ? HINT_TIMED_OUT : HINT_STUCK;
+}
+
+// Franken and Mutant Fish and forcing chains take milliseconds per search,
+// and a guess is no help to a player
+static bool is_hint_technique(TechniqueType tech) {
+    switch (tech) {
+    case TECH_FRANKEN_FISH:
+    case TECH_MUTANT_FISH:
+    case TECH_FORCING_CHAIN:
+    case TECH_GUESS: return false;
+    default: return true;
+    }
+}
+
+static bool is_valid_grid_str(char *grid_str) {
+    if (strncmp(grid_str, "S9B", 3) == 0) {
+        return strlen(grid_str) >= CANDS_STR_LEN;
+    }
+    return strlen(grid_str) >= 81;
+}
+
+// Only the clues are used, since the user's own placements may be wrong.
+// Returns the number of solutions, like backtrack
+static int solve_clues(Grid *grid, unsigned char out_solution[81]) {
+    int clues[81];
+    for (int i = 0; i < 81; i++) {
+        Cell *cell = grid->cells[i];
+        clues[i] = cell->is_clue ? cell->value : 0;
+    }
+    return backtrack_values(clues, out_solution, grid->cancel);
+}
+
+// Records every cell whose placed value is wrong or whose marks no longer
+// include its solution digit
+static bool find_mistakes(Grid *grid, unsigned char solution[81], Hint *out) {
+    for (int i = 0; i < 81; i++) {
+        Cell *cell = grid->cells[i];
+
+        bool is_mistake;
+        if (cell_is_empty(cell)) {
+            is_mistake = !cell_has_cand(cell, solution[i]);
+        } else {
+            is_mistake = cell->value != solution[i];
+        }
+
+        if (is_mistake) {
+            out->mistake_idxs[out->num_mistakes++] = i;
+        }
+    }
+
+    return out->num_mistakes > 0;
+}
@@ -1,42 +1,143 @@
 #include "history.h"
 
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "codec.h"
 #include "dynarr.h"
+#include "explanation.h"
 #include "grid.h"
 #include "solver.h"
 #include "step.h"
 
+static void history_checkpoint(History *hist, Grid *grid);
+
 bool history_can_undo(History *hist) {
     return hist->curr > 0;
 }
 
 bool history_can_redo(History *hist) {
-    return hist->curr < hist->steps.len;
+    return hist->curr < history_len(hist);
 }
 
 bool history_undo(History *hist, Grid *grid) {
     if (!history_can_undo(hist)) return false;
+    Step step;
     hist->curr--;
-    solver_revert_step(grid, history_curr(hist));
+    solver_revert_step(grid, history_step(hist, hist->curr, &step));
     return true;
 }
 
 bool history_redo(History *hist, Grid *grid) {
     if (!history_can_redo(hist)) return false;
-    solver_apply_step(grid, history_curr(hist));
+    Step step;
+    history_checkpoint(hist, grid);
+    solver_apply_step(grid, history_step(hist, hist->curr, &step));
     hist->curr++;
+    history_checkpoint(hist, grid);
     return true;
 }
 
-Step *history_curr(History *hist) {
-    if (hist->curr == 0) return NULL;
-    return &hist->steps.elems[hist->curr - 1];
+// Moves to the state with the first n steps applied. Restores the closest
+// checkpoint at or before n when that is cheaper than walking from the current
+// state, so at most HISTORY_CHECKPOINT_INTERVAL steps are ever replayed
+bool history_seek(History *hist, Grid *grid, int n) {
+    if (n < 0 || n > history_len(hist)) return false;
+
+    int checkpoint_i = n / HISTORY_CHECKPOINT_INTERVAL;
+    if (checkpoint_i >= hist->checkpoints.len) {
+        checkpoint_i = hist->checkpoints.len - 1;
+    }
+
+    if (checkpoint_i >= 0) {
+        int checkpoint_pos = checkpoint_i * HISTORY_CHECKPOINT_INTERVAL;
+        if (n - checkpoint_pos < abs(n - hist->curr)) {
+            grid_restore(grid, &hist->checkpoints.elems[checkpoint_i]);
+            hist->curr = checkpoint_pos;
+        }
+    }
+
+    while (hist->curr < n) {
+        history_redo(hist, grid);
+    }
+    while (hist->curr > n) {
+        history_undo(hist, grid);
+    }
+
+    return true;
 }
 
-void history_add(History *hist, Step step) {
-    da_append(&hist->steps, step);
-    hist->curr++;
+int history_len(History *hist) {
+    return hist->offsets.len;
+}
+
+// Decodes step i into out. Returns out, or NULL if there is no such step
+Step *history_step(History *hist, int i, Step *out) {
+    if (i < 0 || i >= history_len(hist)) return NULL;
+    int offset = hist->offsets.elems[i];
+    step_decode(hist->data.elems + offset, hist->data.len - offset, out);
+    return out;
+}
+
+TechniqueType history_step_tech(History *hist, int i) {
+    int offset = hist->offsets.elems[i];
+    return step_decode_tech(hist->data.elems + offset, hist->data.len - offset);
+}
+
+// Explanations are rendered on first use and kept, so going back and forth
+// over the same steps doesn't format them again
+Explanation *history_explanation(History *hist, int i) {
+    if (i < 0 || i >= history_len(hist)) return NULL;
+
+    if (!hist->explanations.elems[i]) {
+        Step step;
+        hist->explanations.elems[i] =
+            explanation_create(history_step(hist, i, &step));
+    }
+    return hist->explanations.elems[i];
+}
+
+// Returns the index of the first step using tech, searching from step from in
+// direction dir (1 or -1). Returns -1 if there is none
+int history_find_tech(History *hist, TechniqueType tech, int from, int dir) {
+    for (int i = from; i >= 0 && i < history_len(hist); i += dir) {
+        if (history_step_tech(hist, i) == tech) return i;
+    }
+    return -1;
+}
+
+// Decodes the last applied step
+Step *history_curr(History *hist, Step *out) {
+    return history_step(hist, hist->curr - 1, out);
+}
+
+// Decodes the step that history_redo would apply
+Step *history_next(History *hist, Step *out) {
+    return history_step(hist, hist->curr, out);
+}
+
+void history_add(History *hist, Step *step) {
+    da_append(&hist->offsets, hist->data.len);
+    step_encode(&hist->data, step);
+    da_append(&hist->explanations, NULL);
 }
 
 void history_free(History *hist) {
-    da_deinit(&hist->steps);
+    for (int i = 0; i < hist->explanations.len; i++) {
+        explanation_destroy(hist->explanations.elems[i]);
+    }
+    da_deinit(&hist->explanations);
+    da_deinit(&hist->data);
+    da_deinit(&hist->offsets);
+    da_deinit(&hist->checkpoints);
+}
+
+static void history_checkpoint(History *hist, Grid *grid) {
+    if (hist->curr % HISTORY_CHECKPOINT_INTERVAL != 0) return;
+    if (hist->curr / HISTORY_CHECKPOINT_INTERVAL != hist->checkpoints.len) {
+        return;
+    }
+
+    da_reserve(&hist->checkpoints, hist->checkpoints.len + 1);
+    grid_snapshot(grid, &hist->checkpoints.elems[hist->checkpoints.len++]);
 }
@@ -0,0 +1,159 @@
+#include "links.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "bits.h"
+#include "cell.h"
+#include "grid.h"
+
+static void links_update_unit(LinkGraph *links, int unit, int digit);
+static void links_update_cell(LinkGraph *links, int idx);
+
+void links_init(LinkGraph *links) {
+    links->is_built = false;
+}
+
+// Brings the links up to date with cells. Only the units and digits whose
+// places changed are relinked, which after a single step is a few nodes
+void links_update(LinkGraph *links, Cell cells[81]) {
+    unsigned int dirty[27] = {0};
+
+    for (int idx = 0; idx < 81; idx++) {
+        unsigned int cands = cells[idx].cands.cands;
+        unsigned int changed = links->is_built ? cands ^ links->cands[idx]
+                                               : ALL_DIGITS;
+        if (changed == 0) continue;
+
+        links->cands[idx] = cands;
+        dirty[ROW_FROM_IDX(idx)] |= changed;
+        dirty[9 + COL_FROM_IDX(idx)] |= changed;
+        dirty[18 + BOX_FROM_IDX(idx)] |= changed;
+        links_update_cell(links, idx);
+    }
+
+    for (int unit = 0; unit < 27; unit++) {
+        for (int digit = 1; digit <= 9; digit++) {
+            if (IS_BIT_SET(dirty[unit], digit - 1)) {
+                links_update_unit(links, unit, digit);
+            }
+        }
+    }
+
+    links->is_built = true;
+}
+
+bool links_has_node(LinkGraph *links, int node) {
+    return IS_BIT_SET(links->cands[NODE_IDX(node)], NODE_DIGIT(node) - 1);
+}
+
+// Stores the nodes strongly linked to node, each once. Returns how many there
+// are
+int links_strong(LinkGraph *links, int node, int out[NUM_LINK_KINDS]) {
+    int count = 0;
+    for (int kind = 0; kind < NUM_LINK_KINDS; kind++) {
+        int partner = links->strong[node][kind];
+        if (partner == NO_LINK) continue;
+
+        bool is_new = true;
+        for (int i = 0; i < count; i++) {
+            if (out[i] == partner) is_new = false;
+        }
+        if (is_new) {
+            out[count++] = partner;
+        }
+    }
+    return count;
+}
+
+// Stores every candidate that can't be true along with node, which are the
+// other candidates of its cell and its digit in the cell's peers. Returns how
+// many there are
+int links_weak(LinkGraph *links, int node, int out[MAX_WEAK_LINKS]) {
+    int idx = NODE_IDX(node);
+    int digit = NODE_DIGIT(node);
+    int row = ROW_FROM_IDX(idx);
+    int col = COL_FROM_IDX(idx);
+    int count = 0;
+
+    for (int d = 1; d <= 9; d++) {
+        if (d != digit && IS_BIT_SET(links->cands[idx], d - 1)) {
+            out[count++] = NODE(idx, d);
+        }
+    }
+
+    int units[3] = {row, 9 + col, 18 + BOX_FROM_IDX(idx)};
+    for (int u = 0; u < 3; u++) {
+        for (int i = 0; i < 9; i++) {
+            int peer = IDX_FROM_UNIT(units[u], i);
+            if (peer == idx) continue;
+            // Box peers in the same row or column were already seen
+            if (u == 2
+                && (ROW_FROM_IDX(peer) == row || COL_FROM_IDX(peer) == col)) {
+                continue;
+            }
+            if (IS_BIT_SET(links->cands[peer], digit - 1)) {
+                out[count++] = NODE(peer, digit);
+            }
+        }
+    }
+
+    return count;
+}
+
+// Whether a and b can't both be true
+bool links_sees(int a, int b) {
+    if (a == b) return false;
+
+    int idx_a = NODE_IDX(a);
+    int idx_b = NODE_IDX(b);
+    if (idx_a == idx_b) return true;
+    if (NODE_DIGIT(a) != NODE_DIGIT(b)) return false;
+
+    return ROW_FROM_IDX(idx_a) == ROW_FROM_IDX(idx_b)
+           || COL_FROM_IDX(idx_a) == COL_FROM_IDX(idx_b)
+           || BOX_FROM_IDX(idx_a) == BOX_FROM_IDX(idx_b);
+}
+
+// Relinks digit in unit. Its nodes there get a strong link between them if the
+// digit has exactly two places left, and none otherwise
+static void links_update_unit(LinkGraph *links, int unit, int digit) {
+    int kind = unit / 9;
+    int ends[9];
+    int num_ends = 0;
+    unsigned short places = 0;
+
+    for (int i = 0; i < 9; i++) {
+        int idx = IDX_FROM_UNIT(unit, i);
+        links->strong[NODE(idx, digit)][kind] = NO_LINK;
+
+        if (IS_BIT_SET(links->cands[idx], digit - 1)) {
+            places |= BIT(i);
+            ends[num_ends++] = NODE(idx, digit);
+        }
+    }
+
+    links->places[unit][digit - 1] = places;
+    if (num_ends != 2) return;
+
+    links->strong[ends[0]][kind] = ends[1];
+    links->strong[ends[1]][kind] = ends[0];
+}
+
+static void links_update_cell(LinkGraph *links, int idx) {
+    int ends[9];
+    int num_ends = 0;
+
+    for (int digit = 1; digit <= 9; digit++) {
+        links->strong[NODE(idx, digit)][LINK_CELL] = NO_LINK;
+
+        if (IS_BIT_SET(links->cands[idx], digit - 1)) {
+            ends[num_ends++] = NODE(idx, digit);
+        }
+    }
+
+    if (num_ends != 2) return;
+
+    links->strong[ends[0]][LINK_CELL] = ends[1];
+    links->strong[ends[1]][LINK_CELL] = ends[0];
+}
@@ -1,25 +1,142 @@
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "batch.h"
+#include "dynarr.h"
+#include "dynstr.h"
 #include "grid.h"
+#include "hint.h"
 #include "history.h"
+#include "pack.h"
+#include "rating.h"
+#include "solve_ahead.h"
 #include "solver.h"
 #include "step.h"
+#include "trace.h"
 #include "ui.h"
 #include "techniques/backtrack.h"
+#include "techniques/guess.h"
+#include "techniques/registry.h"
+
+#define PACK_ROW_LEN 160
+#define PACK_ROW_FORMAT "%4d  %-9s  %-23s  %5d  %5lld  %.81s"
+#define PACK_ROW_FORMAT_EMPTY "%4d  %-9s  %-23s  %5s  %5s  %.81s"
+// Most hints take well under 1 ms, but a grid beyond every hint technique,
+// such as the Inkala puzzle, takes about 10 ms to report as stuck
+#define HINT_BUDGET_NS 20000000
+// Every guess fills a cell, so no solve can guess deeper than this
+#define MAX_GUESS_DEPTH 81
+
+static int print_usage(void);
+static bool parse_int(char *str, int min, int max, int *out);
+static int run_interactive(char *grid_str);
+static int run_batch(char *puzzles_path, int argc, char *argv[]);
+static bool load_weights(char *weights_path);
+static int run_hint(char *grid_str);
+static int run_steps(char *grid_str);
+static int run_show(char *trace_path, int puzzle, int step_i);
+static int run_pack(char *pack_path);
+static void format_pack_row(Pack *pack, int i, char *out);
+static void open_pack_puzzle(Ui *ui, PackPuzzle *puzzle);
+static void browse_steps(Ui *ui, Grid *grid, History *hist, SolveAhead *ahead,
+                         SolveStatus status);
+static void print_progress(Ui *ui, History *hist, SolveAhead *ahead,
+                           SolveStatus status);
+static void print_curr(Ui *ui, Grid *grid, History *hist, SolveStatus status);
+static void sync_history(History *hist, SolveAhead *ahead, SolveStatus *status);
+static int find_target(Ui *ui, History *hist, InputAction action, int count);
+static int find_same_tech(History *hist, int dir, int count);
+static void show_seek(TraceReader *reader, int puzzle, Grid *grid, int *step_i,
+                      int target);
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: holmes <sudoku>\n");
-        return 1;
+    // Read here so that every mode solves with the same guessing
+    if (argc >= 3 && strcmp(argv[1], "--guess-depth") == 0) {
+        if (!parse_int(argv[2], 0, MAX_GUESS_DEPTH, &guess_max_depth)) {
+            return print_usage();
+        }
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
     }
 
+    if (argc == 2 && argv[1][0] != '-') {
+        return run_interactive(argv[1]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "--batch") == 0) {
+        return run_batch(argv[2], argc - 3, argv + 3);
+    }
+    if (argc == 3 && strcmp(argv[1], "--hint") == 0) {
+        return run_hint(argv[2]);
+    }
+    if (argc == 3 && strcmp(argv[1], "--steps") == 0) {
+        return run_steps(argv[2]);
+    }
+    if (argc == 3 && strcmp(argv[1], "--pack") == 0) {
+        return run_pack(argv[2]);
+    }
+    if (argc == 5 && strcmp(argv[1], "--pack") == 0
+        && strcmp(argv[3], "--weights") == 0) {
+        if (!load_weights(argv[4])) return 1;
+        return run_pack(argv[2]);
+    }
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "--show") == 0) {
+        int puzzle;
+        int step_i = 0;
+        if (!parse_int(argv[3], 0, INT_MAX, &puzzle)
+            || (argc == 5 && !parse_int(argv[4], 0, INT_MAX, &step_i))) {
+            return print_usage();
+        }
+        return run_show(argv[2], puzzle, step_i);
+    }
+
+    return print_usage();
+}
+
+static int print_usage(void) {
+    fprintf(stderr, "Usage: holmes <sudoku>\n"
+                    "       holmes --batch <puzzles> [--trace <trace>] "
+                    "[--timeout <ms>] [--max-steps <n>]\n"
+                    "                      [--weights <weights>] "
+                    "[--check-steps on|off]\n"
+                    "       holmes --hint <sudoku>\n"
+                    "       holmes --steps <sudoku>\n"
+                    "       holmes --pack <puzzles> [--weights <weights>]\n"
+                    "       holmes --show <trace> <puzzle> [<step>]\n"
+                    "\n"
+                    "Any mode can start with --guess-depth <n>, which lets "
+                    "the solver guess up to\n"
+                    "n levels deep when no technique applies. Hints never "
+                    "guess.\n");
+    return 1;
+}
+
+// Reads str as a whole decimal number from min to max into out
+static bool parse_int(char *str, int min, int max, int *out) {
+    char *end;
+    errno = 0;
+    long value = strtol(str, &end, 10);
+    if (end == str || *end != '\0' || errno == ERANGE || value < min
+        || value > max) {
+        return false;
+    }
+
+    *out = value;
+    return true;
+}
+
+static int run_interactive(char *grid_str) {
     Ui ui;
 
-    Grid *grid = grid_create(argv[1]);
+    Grid *grid = grid_create(grid_str);
     History hist = {0};
     ui_init(&ui);
 
-    int num_solutions = backtrack(grid);
+    int num_solutions = backtrack(grid, grid->solution);
+    grid->has_solution = num_solutions == 1;
 
     ui_print_grid(&ui, grid, NULL);
 
@@ -31,7 +148,7 @@ int main(int argc, char *argv[]) {
         }
 
         while (true) {
-            switch (ui_wait_for_input()) {
+            switch (ui_wait_for_input(NULL)) {
             case ACTION_QUIT:
             case ACTION_NEXT: goto cleanup;
             default: break;
@@ -39,79 +156,551 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    SolveAhead ahead;
+    solve_ahead_start(&ahead, grid);
+
     bool waiting = true;
     while (waiting) {
-        switch (ui_wait_for_input()) {
+        print_progress(&ui, &hist, &ahead, SOLVE_ONGOING);
+        switch (ui_wait_for_input(NULL)) {
         case ACTION_QUIT: goto cleanup;
         case ACTION_NEXT: waiting = false;
         default: break;
         }
     }
 
-    SolveStatus status;
-    while (1) {
-        Step step;
-        status = solver_next_step(grid, &step);
+    browse_steps(&ui, grid, &hist, &ahead, SOLVE_ONGOING);
+
+cleanup:
+    if (num_solutions == 1) {
+        solve_ahead_stop(&ahead);
+    }
+    ui_deinit(&ui);
+    history_free(&hist);
+    grid_destroy(grid);
+
+    return 0;
+}
 
-        if (status != SOLVE_ONGOING) break;
+// Reads the options following the puzzles path. Each one takes a value
+static int run_batch(char *puzzles_path, int argc, char *argv[]) {
+    char *trace_path = NULL;
+    int timeout_ms = 0;
+    int max_steps = 0;
 
-        ui_print_grid(&ui, grid, &step);
-        ui_print_step(&ui, &step);
-        history_add(&hist, step);
+    if (argc % 2 != 0) return print_usage();
 
-        waiting = true;
-        while (waiting) {
-            switch (ui_wait_for_input()) {
-            case ACTION_QUIT: goto cleanup;
-            case ACTION_PREV:
-                if (!history_undo(&hist, grid)) {
-                    ui_print_message(&ui, "Already at initial state\n");
-                } else {
-                    ui_print_grid(&ui, grid, history_curr(&hist));
-                    ui_print_step(&ui, history_curr(&hist));
-                }
-                break;
-            case ACTION_NEXT:
-                if (!history_redo(&hist, grid)) {
-                    waiting = false;
-                    break;
-                }
-                ui_print_grid(&ui, grid, history_curr(&hist));
-                ui_print_step(&ui, history_curr(&hist));
-                break;
-            case ACTION_SCROLL_UP: ui_scroll(&ui, -1); break;
-            case ACTION_SCROLL_DOWN: ui_scroll(&ui, 1); break;
+    for (int i = 0; i < argc; i += 2) {
+        if (strcmp(argv[i], "--trace") == 0) {
+            trace_path = argv[i + 1];
+        } else if (strcmp(argv[i], "--timeout") == 0) {
+            if (!parse_int(argv[i + 1], 0, INT_MAX, &timeout_ms)) {
+                return print_usage();
+            }
+        } else if (strcmp(argv[i], "--max-steps") == 0) {
+            if (!parse_int(argv[i + 1], 0, INT_MAX, &max_steps)) {
+                return print_usage();
             }
+        } else if (strcmp(argv[i], "--check-steps") == 0) {
+            solver_check_steps = strcmp(argv[i + 1], "on") == 0;
+        } else if (strcmp(argv[i], "--weights") == 0) {
+            if (!load_weights(argv[i + 1])) return 1;
+        } else {
+            return print_usage();
         }
+    }
 
-        solver_apply_step(grid, &step);
+    long long budget_ns = timeout_ms * 1000000LL;
+    return batch_run(puzzles_path, trace_path, budget_ns, max_steps);
+}
+
+static bool load_weights(char *weights_path) {
+    int bad_line;
+    if (rating_load_weights(weights_path, &bad_line)) return true;
+
+    if (bad_line == 0) {
+        fprintf(stderr, "Could not load rating weights from %s\n",
+                weights_path);
+    } else {
+        fprintf(stderr, "Invalid rating weight on line %d of %s\n", bad_line,
+                weights_path);
     }
+    return false;
+}
 
-    ui_print_grid(&ui, grid, NULL);
+// Prints the easiest step for grid_str, or the cells where its values or
+// pencil marks disagree with the solution
+static int run_hint(char *grid_str) {
+    Hint hint;
+    hint_init(&hint);
+
+    HintStatus status = hint_find(grid_str, HINT_BUDGET_NS, &hint);
+    switch (status) {
+    case HINT_FOUND:
+        printf("%.*s", hint.explanation.len, hint.explanation.elems);
+        break;
+    case HINT_MISTAKES:
+        for (int i = 0; i < hint.num_mistakes; i++) {
+            int idx = hint.mistake_idxs[i];
+            printf("Mistake at r%dc%d\n", ROW_FROM_IDX(idx) + 1,
+                   COL_FROM_IDX(idx) + 1);
+        }
+        break;
+    default: printf("%s\n", hint_status_name(status)); break;
+    }
+
+    hint_deinit(&hint);
+
+    return status == HINT_FOUND ? 0 : 1;
+}
+
+// Lists every distinct step available in the grid, easiest technique first
+static int run_steps(char *grid_str) {
+    Grid *grid = grid_create(grid_str);
+    grid->has_solution = backtrack(grid, grid->solution) == 1;
+    if (!grid->has_solution) {
+        fprintf(stderr, "Invalid Sudoku\n");
+        grid_destroy(grid);
+        return 1;
+    }
+
+    Steps steps;
+    da_init(&steps);
+    int num_steps = solver_all_steps(grid, &steps);
+
+    DynStr explanation;
+    ds_init(&explanation);
+    for (int i = 0; i < num_steps; i++) {
+        ds_clear(&explanation);
+        technique_ops[steps.elems[i].tech].explain(&explanation,
+                                                   &steps.elems[i]);
+        printf("%.*s", explanation.len, explanation.elems);
+    }
+
+    ds_deinit(&explanation);
+    da_deinit(&steps);
+    grid_destroy(grid);
+
+    return num_steps > 0 ? 0 : 1;
+}
+
+// Lists the puzzles in pack_path with their status and rating. They
+// are solved in the background starting from the selected one, so opening a
+// puzzle only waits if the workers haven't got to it yet
+static int run_pack(char *pack_path) {
+    Pack pack;
+    if (!pack_open(&pack, pack_path)) {
+        fprintf(stderr, "Could not open %s\n", pack_path);
+        return 1;
+    }
+
+    int num_puzzles = pack.puzzles.len;
+    if (num_puzzles == 0) {
+        fprintf(stderr, "No puzzles found in %s\n", pack_path);
+        pack_close(&pack);
+        return 1;
+    }
+
+    char **rows = malloc(num_puzzles * sizeof(char *));
+    for (int i = 0; i < num_puzzles; i++) {
+        rows[i] = malloc(PACK_ROW_LEN);
+    }
+
+    Ui ui;
+    ui_init(&ui);
+
+    int selected = 0;
+    int opening = -1;
+    char input[32];
+    while (true) {
+        if (opening != -1 && pack_state(&pack, opening) == PUZZLE_DONE) {
+            open_pack_puzzle(&ui, &pack.puzzles.elems[opening]);
+            opening = -1;
+        }
+
+        for (int i = 0; i < num_puzzles; i++) {
+            format_pack_row(&pack, i, rows[i]);
+        }
+        ui_print_list(&ui, rows, num_puzzles, selected);
+
+        if (opening != -1) {
+            ui_print_status(&ui, "Solving puzzle %d...", opening + 1);
+        } else {
+            ui_print_status(&ui, "%d of %d puzzles solved",
+                            pack_num_done(&pack), num_puzzles);
+        }
+
+        int count;
+        switch (ui_wait_for_input(&count)) {
+        case ACTION_QUIT:
+            if (opening == -1) goto cleanup;
+            opening = -1;
+            break;
+        case ACTION_NEXT: opening = selected; break;
+        case ACTION_SCROLL_UP: selected -= count; break;
+        case ACTION_SCROLL_DOWN: selected += count; break;
+        case ACTION_FIRST: selected = 0; break;
+        case ACTION_LAST: selected = num_puzzles - 1; break;
+        case ACTION_GOTO:
+            if (ui_prompt(&ui, "Go to puzzle: ", input, sizeof(input) - 1)) {
+                selected = atoi(input) - 1;
+            }
+            break;
+        default: break;
+        }
+
+        if (selected < 0) selected = 0;
+        if (selected >= num_puzzles) selected = num_puzzles - 1;
+        pack_set_cursor(&pack, selected);
+    }
+
+cleanup:
+    ui_deinit(&ui);
+    for (int i = 0; i < num_puzzles; i++) {
+        free(rows[i]);
+    }
+    free(rows);
+    pack_close(&pack);
+
+    return 0;
+}
+
+static void format_pack_row(Pack *pack, int i, char *out) {
+    PackPuzzle *puzzle = &pack->puzzles.elems[i];
+
+    switch (pack_state(pack, i)) {
+    case PUZZLE_PENDING:
+        snprintf(out, PACK_ROW_LEN, PACK_ROW_FORMAT_EMPTY, i + 1, "Queued",
+                 "", "", "", puzzle->grid_str);
+        break;
+    case PUZZLE_SOLVING:
+        snprintf(out, PACK_ROW_LEN, PACK_ROW_FORMAT_EMPTY, i + 1, "Solving",
+                 "", "", "", puzzle->grid_str);
+        break;
+    case PUZZLE_DONE: {
+        Rating *rating = &puzzle->rating;
+        snprintf(out, PACK_ROW_LEN, PACK_ROW_FORMAT, i + 1,
+                 solve_status_name(puzzle->status),
+                 rating->hardest == -1 ? "" : technique_names[rating->hardest],
+                 history_len(&puzzle->hist), rating->score, puzzle->grid_str);
+        break;
+    }
+    }
+}
+
+// Steps through a puzzle whose trace is ready, leaving its history back at
+// the start for the next time it's opened
+static void open_pack_puzzle(Ui *ui, PackPuzzle *puzzle) {
+    Grid *grid = grid_create(puzzle->grid_str);
+
+    ui_hide_list(ui);
+    browse_steps(ui, grid, &puzzle->hist, NULL, puzzle->status);
+
+    history_seek(&puzzle->hist, grid, 0);
+    grid_destroy(grid);
+}
+
+// Steps come from the solve-ahead thread if ahead is not NULL, so input is
+// never blocked by the technique search. If the next step isn't ready yet, the
+// grid is shown without it until it arrives. Otherwise hist already holds
+// every step and status is the final status. Queued keypresses arrive as one
+// action with a count, so the grid is only drawn for the state the user ends
+// up at. Returns when the user quits or moves past the last step
+static void browse_steps(Ui *ui, Grid *grid, History *hist, SolveAhead *ahead,
+                         SolveStatus status) {
+    bool redraw = true;
+    while (true) {
+        if (ahead) {
+            int old_len = history_len(hist);
+            SolveStatus old_status = status;
+            sync_history(hist, ahead, &status);
+            if (hist->curr == old_len
+                && (history_len(hist) != old_len || status != old_status)) {
+                redraw = true;
+            }
+        }
+
+        if (redraw) {
+            print_curr(ui, grid, hist, status);
+            redraw = false;
+        }
+
+        print_progress(ui, hist, ahead, status);
+
+        int count;
+        InputAction action = ui_wait_for_input(&count);
+        switch (action) {
+        case ACTION_NONE: break;
+        case ACTION_QUIT: return;
+        case ACTION_SCROLL_UP: ui_scroll(ui, -count); break;
+        case ACTION_SCROLL_DOWN: ui_scroll(ui, count); break;
+        default:
+            if (action == ACTION_NEXT && hist->curr == history_len(hist)
+                && status != SOLVE_ONGOING) {
+                return;
+            }
+
+            int target = find_target(ui, hist, action, count);
+            if (target != -1 && target != hist->curr) {
+                history_seek(hist, grid, target);
+                redraw = true;
+            }
+            break;
+        }
+    }
+}
+
+static void print_progress(Ui *ui, History *hist, SolveAhead *ahead,
+                           SolveStatus status) {
+    int num_found = history_len(hist);
+    if (ahead) {
+        num_found = solve_ahead_progress(ahead, &status);
+    }
+
+    if (status == SOLVE_ONGOING) {
+        ui_print_status(ui, "Step %d. Solving ahead, %d steps found so far",
+                        hist->curr + 1, num_found);
+    } else if (hist->curr == num_found) {
+        ui_print_status(ui, "All %d steps applied. Solver finished: %s",
+                        num_found, solve_status_name(status));
+    } else {
+        ui_print_status(ui, "Step %d of %d. Solver finished: %s",
+                        hist->curr + 1, num_found, solve_status_name(status));
+    }
+}
+
+// Shows the grid with the step that comes after the current state, or the
+// final result if there are no more steps
+static void print_curr(Ui *ui, Grid *grid, History *hist, SolveStatus status) {
+    Step next;
+    if (history_next(hist, &next)) {
+        ui_print_grid(ui, grid, &next);
+        ui_print_explanation(ui, history_explanation(hist, hist->curr));
+        return;
+    }
+
+    ui_print_grid(ui, grid, NULL);
 
     switch (status) {
+    case SOLVE_ONGOING:
+        ui_print_message(ui, "Searching for the next step...\n");
+        break;
     case SOLVE_COMPLETE:
-        ui_print_message(&ui, "Sudoku solved successfully\n");
+        ui_print_message(ui, "Sudoku solved successfully\n");
         break;
     case SOLVE_STUCK:
-        ui_print_message(&ui, "Solver stuck. No further progress possible with "
-                              "available techniques\n");
+        ui_print_message(ui, "Solver stuck. No further progress possible with "
+                             "available techniques\n");
+        break;
+    case SOLVE_INVALID:
+        ui_print_message(ui, "Invalid Sudoku. It doesn't have exactly one "
+                             "solution\n");
+        break;
+    case SOLVE_TIMED_OUT:
+        ui_print_message(ui, "Solver gave up. It ran out of time or steps\n");
+        break;
+    case SOLVE_BAD_STEP:
+        ui_print_message(ui, "Solver stopped. The last step contradicts the "
+                             "solution\n");
         break;
     default: break;
     }
+}
+
+// Moves every step the solve-ahead thread has found so far into the history
+static void sync_history(History *hist, SolveAhead *ahead,
+                         SolveStatus *status) {
+    Step step;
+    while (solve_ahead_step(ahead, history_len(hist), &step, status)) {
+        history_add(hist, &step);
+    }
+}
+
+// Returns the number of applied steps action leads to, or -1 if it can't be
+// carried out, in which case the reason is shown to the user
+static int find_target(Ui *ui, History *hist, InputAction action, int count) {
+    int len = history_len(hist);
+    char input[32];
+    int target;
+
+    switch (action) {
+    case ACTION_PREV:
+        if (hist->curr == 0) {
+            ui_print_message(ui, "Already at initial state\n");
+            return -1;
+        }
+        return hist->curr - count < 0 ? 0 : hist->curr - count;
+    case ACTION_NEXT:
+        return hist->curr + count > len ? len : hist->curr + count;
+    case ACTION_FIRST: return 0;
+    case ACTION_LAST: return len;
+    case ACTION_PREV_SAME_TECH:
+    case ACTION_NEXT_SAME_TECH:
+        target = find_same_tech(
+            hist, action == ACTION_NEXT_SAME_TECH ? 1 : -1, count);
+        if (target == -1) {
+            ui_print_message(ui, "No other step found using this technique\n");
+        }
+        return target;
+    case ACTION_FIND_TECH:
+        if (!ui_prompt(ui, "Find technique: ", input, sizeof(input) - 1)
+            || input[0] == '\0') {
+            return -1;
+        }
+
+        int tech = technique_from_name(input);
+        if (tech == -1) {
+            ui_print_message(ui, "Unknown technique: %s\n", input);
+            return -1;
+        }
+
+        target = history_find_tech(hist, tech, hist->curr + 1, 1);
+        if (target == -1) {
+            ui_print_message(ui, "No later %s found so far\n",
+                             technique_names[tech]);
+        }
+        return target;
+    case ACTION_GOTO:
+        if (!ui_prompt(ui, "Go to step: ", input, sizeof(input) - 1)
+            || input[0] == '\0') {
+            return -1;
+        }
+
+        target = atoi(input) - 1;
+        if (target < 0 || target > len) {
+            ui_print_message(ui, "Step must be between 1 and %d\n", len + 1);
+            return -1;
+        }
+        return target;
+    default: return -1;
+    }
+}
+
+// Finds the count-th step in direction dir using the same technique as the
+// next step to be applied
+static int find_same_tech(History *hist, int dir, int count) {
+    if (hist->curr == history_len(hist)) return -1;
+
+    TechniqueType tech = history_step_tech(hist, hist->curr);
+    int target = hist->curr;
+    for (int i = 0; i < count; i++) {
+        int found = history_find_tech(hist, tech, target + dir, dir);
+        if (found == -1) break;
+        target = found;
+    }
+
+    return target == hist->curr ? -1 : target;
+}
+
+// Browses a puzzle stored by batch mode, starting with step step_i. Steps are
+// read straight from the memory-mapped trace instead of being solved again
+static int run_show(char *trace_path, int puzzle, int step_i) {
+    TraceReader reader;
+    if (!trace_reader_open(&reader, trace_path)) {
+        fprintf(stderr, "Could not read trace %s\n", trace_path);
+        return 1;
+    }
+    if (puzzle < 0 || puzzle >= reader.num_puzzles) {
+        fprintf(stderr, "Puzzle %d not found. The trace holds %d puzzles\n",
+                puzzle, reader.num_puzzles);
+        trace_reader_close(&reader);
+        return 1;
+    }
+    if (!trace_reader_check(&reader, puzzle)) {
+        fprintf(stderr, "Puzzle %d is malformed in trace %s\n", puzzle,
+                trace_path);
+        trace_reader_close(&reader);
+        return 1;
+    }
 
+    Grid *grid = trace_reader_grid(&reader, puzzle);
+    int num_steps = trace_reader_num_steps(&reader, puzzle);
+    if (step_i < 0) step_i = 0;
+    if (step_i > num_steps) step_i = num_steps;
+
+    int target = step_i;
+    step_i = 0;
+    show_seek(&reader, puzzle, grid, &step_i, target);
+
+    Ui ui;
+    ui_init(&ui);
+
+    Step step;
+    bool redraw = true;
     while (true) {
-        switch (ui_wait_for_input()) {
-        case ACTION_QUIT:
-        case ACTION_NEXT: goto cleanup;
-        default: break;
+        Step *curr = trace_reader_step(&reader, puzzle, step_i, &step);
+
+        if (redraw) {
+            ui_print_grid(&ui, grid, curr);
+            if (curr) {
+                ui_print_step(&ui, curr);
+            } else {
+                SolveStatus status = trace_reader_status(&reader, puzzle);
+                ui_print_message(&ui, "End of trace. %s after %d steps\n",
+                                 solve_status_name(status), num_steps);
+            }
+        }
+        redraw = true;
+
+        int count;
+        switch (ui_wait_for_input(&count)) {
+        case ACTION_QUIT: goto cleanup;
+        case ACTION_PREV:
+            if (step_i == 0) {
+                ui_print_message(&ui, "Already at initial state\n");
+                redraw = false;
+                break;
+            }
+            show_seek(&reader, puzzle, grid, &step_i, step_i - count);
+            break;
+        case ACTION_NEXT:
+            if (!curr) {
+                redraw = false;
+                break;
+            }
+            show_seek(&reader, puzzle, grid, &step_i, step_i + count);
+            break;
+        case ACTION_FIRST: show_seek(&reader, puzzle, grid, &step_i, 0); break;
+        case ACTION_LAST:
+            show_seek(&reader, puzzle, grid, &step_i, num_steps);
+            break;
+        case ACTION_SCROLL_UP:
+            ui_scroll(&ui, -count);
+            redraw = false;
+            break;
+        case ACTION_SCROLL_DOWN:
+            ui_scroll(&ui, count);
+            redraw = false;
+            break;
+        default: redraw = false; break;
         }
     }
 
 cleanup:
     ui_deinit(&ui);
-    history_free(&hist);
     grid_destroy(grid);
+    trace_reader_close(&reader);
 
     return 0;
 }
+
+// Applies or reverts steps until the first target steps of the trace are
+// applied. target is clamped to the steps in the trace
+static void show_seek(TraceReader *reader, int puzzle, Grid *grid, int *step_i,
+                      int target) {
+    int num_steps = trace_reader_num_steps(reader, puzzle);
+    if (target < 0) target = 0;
+    if (target > num_steps) target = num_steps;
+
+    Step step;
+    while (*step_i < target) {
+        trace_reader_step(reader, puzzle, *step_i, &step);
+        solver_apply_step(grid, &step);
+        (*step_i)++;
+    }
+    while (*step_i > target) {
+        (*step_i)--;
+        trace_reader_step(reader, puzzle, *step_i, &step);
+        solver_revert_step(grid, &step);
+    }
+}
@@ -0,0 +1,148 @@
+#include "pack.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cancel.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "history.h"
+#include "rating.h"
+#include "solver.h"
+#include "step.h"
+#include "techniques/registry.h"
+
+static void *pack_work(void *arg);
+static int pack_claim(Pack *pack);
+
+// Reads every puzzle in path and starts solving them in the background
+bool pack_open(Pack *pack, char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+
+    da_init(&pack->puzzles);
+
+    char line[MAX_LINE_LEN];
+    while (batch_read_puzzle(file, line)) {
+        PackPuzzle puzzle = {.state = PUZZLE_PENDING};
+        strcpy(puzzle.grid_str, line);
+        rating_init(&puzzle.rating);
+        da_append(&pack->puzzles, puzzle);
+    }
+
+    fclose(file);
+
+    pthread_mutex_init(&pack->lock, NULL);
+    pack->cursor = 0;
+    pack->stop = false;
+    cancel_init(&pack->cancel, 0, 0);
+
+    // One core is left for the UI
+    pack->num_workers = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (pack->num_workers < 1) pack->num_workers = 1;
+    if (pack->num_workers > PACK_MAX_WORKERS) {
+        pack->num_workers = PACK_MAX_WORKERS;
+    }
+
+    for (int i = 0; i < pack->num_workers; i++) {
+        pthread_create(&pack->workers[i], NULL, pack_work, pack);
+    }
+
+    return true;
+}
+
+// Cuts short the puzzles the workers are solving, waits for them and frees the
+// pack
+void pack_close(Pack *pack) {
+    pthread_mutex_lock(&pack->lock);
+    pack->stop = true;
+    pthread_mutex_unlock(&pack->lock);
+    cancel_request(&pack->cancel);
+
+    for (int i = 0; i < pack->num_workers; i++) {
+        pthread_join(pack->workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pack->lock);
+    for (int i = 0; i < pack->puzzles.len; i++) {
+        history_free(&pack->puzzles.elems[i].hist);
+    }
+    da_deinit(&pack->puzzles);
+}
+
+// Makes the workers continue from puzzle cursor, so the puzzles the user is
+// about to open are solved first
+void pack_set_cursor(Pack *pack, int cursor) {
+    pthread_mutex_lock(&pack->lock);
+    pack->cursor = cursor;
+    pthread_mutex_unlock(&pack->lock);
+}
+
+PuzzleState pack_state(Pack *pack, int i) {
+    pthread_mutex_lock(&pack->lock);
+    PuzzleState state = pack->puzzles.elems[i].state;
+    pthread_mutex_unlock(&pack->lock);
+    return state;
+}
+
+int pack_num_done(Pack *pack) {
+    int num_done = 0;
+
+    pthread_mutex_lock(&pack->lock);
+    for (int i = 0; i < pack->puzzles.len; i++) {
+        if (pack->puzzles.elems[i].state == PUZZLE_DONE) num_done++;
+    }
+    pthread_mutex_unlock(&pack->lock);
+
+    return num_done;
+}
+
+static void *pack_work(void *arg) {
+    Pack *pack = arg;
+
+    int i;
+    while ((i = pack_claim(pack)) != -1) {
+        PackPuzzle *puzzle = &pack->puzzles.elems[i];
+
+        Grid *grid = grid_create(puzzle->grid_str);
+        grid->cancel = &pack->cancel;
+
+        Rating rating;
+        rating_init(&rating);
+        SolveStatus status = batch_solve(grid, &puzzle->hist, NULL, &rating);
+        grid_destroy(grid);
+
+        pthread_mutex_lock(&pack->lock);
+        puzzle->status = status;
+        puzzle->rating = rating;
+        puzzle->state = PUZZLE_DONE;
+        pthread_mutex_unlock(&pack->lock);
+    }
+
+    return NULL;
+}
+
+// Marks the first pending puzzle at or after the cursor as being solved,
+// wrapping around to the start of the pack. Returns -1 once there are none
+// left or the pack is being closed
+static int pack_claim(Pack *pack) {
+    pthread_mutex_lock(&pack->lock);
+
+    int claimed = -1;
+    for (int n = 0; n < pack->puzzles.len && !pack->stop; n++) {
+        int i = (pack->cursor + n) % pack->puzzles.len;
+        if (pack->puzzles.elems[i].state == PUZZLE_PENDING) {
+            pack->puzzles.elems[i].state = PUZZLE_SOLVING;
+            claimed = i;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&pack->lock);
+
+    return claimed;
+}
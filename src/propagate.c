@@ -0,0 +1,192 @@
+#include "propagate.h"
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "bits.h"
+#include "cell.h"
+#include "grid.h"
+#include "links.h"
+
+static bool propagate(Propagator *prop);
+static bool prop_place(Propagator *prop, int node, int cause);
+static bool prop_remove(Propagator *prop, int idx, int digit, int cause);
+static bool check_units(Propagator *prop, int idx, int digit, int cause);
+static void enqueue(Propagator *prop, int node, int cause);
+static void save(Propagator *prop, int idx);
+static bool fail(Propagator *prop, int idx, int unit, int digit, int cause);
+
+void prop_init(Propagator *prop, Grid *grid) {
+    prop->peer_masks = grid->peer_masks;
+    for (int idx = 0; idx < 81; idx++) {
+        prop->cands[idx] = grid->cells[idx]->cands.cands;
+        prop->values[idx] = grid->cells[idx]->value;
+    }
+    prop->trail_len = 0;
+}
+
+int prop_mark(Propagator *prop) {
+    return prop->trail_len;
+}
+
+// Takes back every change made since mark
+void prop_undo(Propagator *prop, int mark) {
+    while (prop->trail_len > mark) {
+        PropChange *change = &prop->trail[--prop->trail_len];
+        prop->cands[change->idx] = change->cands;
+        prop->values[change->idx] = change->value;
+    }
+}
+
+// Places node and everything it forces. Returns false on a conflict, which is
+// left in prop->conflict. Either way the changes stay until undone
+bool prop_assume(Propagator *prop, int node) {
+    prop->queue_len = 0;
+    enqueue(prop, node, NO_CAUSE);
+    return propagate(prop);
+}
+
+// Removes node and propagates like prop_assume
+bool prop_exclude(Propagator *prop, int node) {
+    prop->queue_len = 0;
+    if (!prop_remove(prop, NODE_IDX(node), NODE_DIGIT(node), NO_CAUSE)) {
+        return false;
+    }
+    return propagate(prop);
+}
+
+bool prop_has_node(Propagator *prop, int node) {
+    return IS_BIT_SET(prop->cands[NODE_IDX(node)], NODE_DIGIT(node) - 1);
+}
+
+bool prop_is_placed(Propagator *prop, int node) {
+    return prop->values[NODE_IDX(node)] == NODE_DIGIT(node);
+}
+
+bool prop_is_solved(Propagator *prop) {
+    for (int idx = 0; idx < 81; idx++) {
+        if (prop->values[idx] == 0) return false;
+    }
+    return true;
+}
+
+// Stores the placements that led from the latest assumption to node, which was
+// placed by it, starting with the assumption. Returns how many there are, or -1
+// if there are more than max_len
+int prop_chain(Propagator *prop, int node, short out[], int max_len) {
+    int len = 0;
+    for (int n = node; n != NO_CAUSE; n = prop->place_causes[n]) {
+        if (++len > max_len) return -1;
+    }
+
+    int n = node;
+    for (int i = len - 1; i >= 0; i--) {
+        out[i] = n;
+        n = prop->place_causes[n];
+    }
+    return len;
+}
+
+// The queue is worked through first in, first out, so every placement is
+// reached from the assumption by about the fewest steps
+static bool propagate(Propagator *prop) {
+    for (int head = 0; head < prop->queue_len; head++) {
+        if (!prop_place(prop, prop->queue[head], prop->queue_causes[head])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool prop_place(Propagator *prop, int node, int cause) {
+    int idx = NODE_IDX(node);
+    int digit = NODE_DIGIT(node);
+
+    if (prop->values[idx] == digit) return true;
+    if (prop->values[idx] != 0 || !prop_has_node(prop, node)) {
+        return fail(prop, idx, -1, digit, cause);
+    }
+
+    unsigned int others = UNSET_BIT(prop->cands[idx], digit - 1);
+    save(prop, idx);
+    prop->values[idx] = digit;
+    prop->cands[idx] = 0;
+    prop->place_causes[node] = cause;
+
+    // The cell's other candidates are gone, which may leave them a single
+    // place in one of its units
+    for (int d = 1; d <= 9; d++) {
+        if (!IS_BIT_SET(others, d - 1)) continue;
+        prop->removal_causes[NODE(idx, d)] = node;
+        if (!check_units(prop, idx, d, node)) return false;
+    }
+
+    Bitboard peers = prop->peer_masks[idx];
+    for (int peer = bb_first(peers); peer != -1; peer = bb_first(peers)) {
+        bb_remove(&peers, peer);
+        if (!IS_BIT_SET(prop->cands[peer], digit - 1)) continue;
+        if (!prop_remove(prop, peer, digit, node)) return false;
+    }
+
+    return true;
+}
+
+static bool prop_remove(Propagator *prop, int idx, int digit, int cause) {
+    save(prop, idx);
+    prop->cands[idx] = UNSET_BIT(prop->cands[idx], digit - 1);
+    prop->removal_causes[NODE(idx, digit)] = cause;
+
+    unsigned int cands = prop->cands[idx];
+    if (cands == 0) return fail(prop, idx, -1, 0, cause);
+    if ((cands & (cands - 1)) == 0) {
+        enqueue(prop, NODE(idx, __builtin_ctz(cands) + 1), cause);
+    }
+
+    return check_units(prop, idx, digit, cause);
+}
+
+// Looks for digit's last place in each unit of idx, after it left idx
+static bool check_units(Propagator *prop, int idx, int digit, int cause) {
+    int units[3] = {ROW_FROM_IDX(idx), 9 + COL_FROM_IDX(idx),
+                    18 + BOX_FROM_IDX(idx)};
+
+    for (int u = 0; u < 3; u++) {
+        int num_places = 0;
+        int place = -1;
+        bool is_placed = false;
+
+        for (int i = 0; i < 9 && !is_placed; i++) {
+            int cell = IDX_FROM_UNIT(units[u], i);
+            is_placed = prop->values[cell] == digit;
+            if (IS_BIT_SET(prop->cands[cell], digit - 1)) {
+                num_places++;
+                place = cell;
+            }
+        }
+
+        if (is_placed) continue;
+        if (num_places == 0) return fail(prop, -1, units[u], digit, cause);
+        if (num_places == 1) {
+            enqueue(prop, NODE(place, digit), cause);
+        }
+    }
+
+    return true;
+}
+
+static void enqueue(Propagator *prop, int node, int cause) {
+    prop->queue[prop->queue_len] = node;
+    prop->queue_causes[prop->queue_len] = cause;
+    prop->queue_len++;
+}
+
+static void save(Propagator *prop, int idx) {
+    prop->trail[prop->trail_len++] = (PropChange){
+        .idx = idx, .cands = prop->cands[idx], .value = prop->values[idx]};
+}
+
+static bool fail(Propagator *prop, int idx, int unit, int digit, int cause) {
+    prop->conflict = (PropConflict){
+        .idx = idx, .unit = unit, .digit = digit, .cause = cause};
+    return false;
+}
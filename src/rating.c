@@ -0,0 +1,168 @@
+#include "rating.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "step.h"
+#include "techniques/registry.h"
+
+#define MAX_WEIGHTS_LINE_LEN 128
+
+static bool parse_weight(char *line, int weights[NUM_TECHNIQUES]);
+
+// Roughly ten times the Sudoku Explainer ratings, which keeps the scores
+// comparable with the ones people already know
+int rating_weights[NUM_TECHNIQUES] = {
+    [TECH_NAKED_SINGLE] = 10,
+    [TECH_HIDDEN_SINGLE] = 12,
+    [TECH_NAKED_PAIR] = 30,
+    [TECH_NAKED_TRIPLE] = 36,
+    [TECH_NAKED_QUAD] = 50,
+    [TECH_HIDDEN_PAIR] = 34,
+    [TECH_HIDDEN_TRIPLE] = 40,
+    [TECH_HIDDEN_QUAD] = 54,
+    [TECH_POINTING_SET] = 26,
+    [TECH_X_WING] = 32,
+    [TECH_SWORDFISH] = 38,
+    [TECH_JELLYFISH] = 52,
+    [TECH_FINNED_X_WING] = 34,
+    [TECH_FINNED_SWORDFISH] = 40,
+    [TECH_FINNED_JELLYFISH] = 54,
+    [TECH_XY_WING] = 42,
+    [TECH_XYZ_WING] = 44,
+    [TECH_W_WING] = 44,
+    [TECH_SIMPLE_COLORING] = 46,
+    [TECH_MULTI_COLORING] = 50,
+    [TECH_AIC] = 66,
+    [TECH_SUE_DE_COQ] = 56,
+    [TECH_ALS_XZ] = 70,
+    [TECH_FORCING_CHAIN] = 80,
+    [TECH_UNIQUE_RECTANGLE_1] = 45,
+    [TECH_UNIQUE_RECTANGLE_2] = 46,
+    [TECH_UNIQUE_RECTANGLE_3] = 48,
+    [TECH_UNIQUE_RECTANGLE_4] = 46,
+    [TECH_BUG_PLUS_1] = 56,
+    [TECH_PATTERN_OVERLAY] = 76,
+    [TECH_FRANKEN_FISH] = 72,
+    [TECH_MUTANT_FISH] = 74,
+    [TECH_GUESS] = 100,
+};
+
+void rating_init(Rating *rating) {
+    rating->hardest = -1;
+    rating->score = 0;
+    rating->guess_depth = 0;
+    memset(rating->counts, 0, sizeof(rating->counts));
+}
+
+void rating_add_step(Rating *rating, Step *step) {
+    TechniqueType tech = step->tech;
+    int weight = rating_weights[tech];
+
+    rating->counts[tech]++;
+    rating->score += weight;
+    if (rating->hardest == -1 || weight > rating_weights[rating->hardest]) {
+        rating->hardest = tech;
+    }
+    if (tech == TECH_GUESS && step->as.guess.depth > rating->guess_depth) {
+        rating->guess_depth = step->as.guess.depth;
+    }
+}
+
+// Merges rating into total, as if its steps had been added one by one
+void rating_add(Rating *total, Rating *rating) {
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        total->counts[i] += rating->counts[i];
+    }
+    total->score += rating->score;
+    if (rating->guess_depth > total->guess_depth) {
+        total->guess_depth = rating->guess_depth;
+    }
+    if (rating->hardest != -1
+        && (total->hardest == -1
+            || rating_weights[rating->hardest]
+                   > rating_weights[total->hardest])) {
+        total->hardest = rating->hardest;
+    }
+}
+
+// Reads lines of the form "<technique>: <weight>", where the technique is
+// named in full, ignoring case. Blanks around the name and the weight are
+// ignored, and blank lines and comments starting with '#' are skipped. Techniques that aren't listed keep their weight. Returns false if
+// the file can't be read or a line can't be parsed, leaving the weights as
+// they were. out_bad_line is set to the number of the first bad line, or 0 if
+// the file couldn't be read
+bool rating_load_weights(char *path, int *out_bad_line) {
+    *out_bad_line = 0;
+
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+
+    int weights[NUM_TECHNIQUES];
+    memcpy(weights, rating_weights, sizeof(weights));
+
+    bool ok = true;
+    char line[MAX_WEIGHTS_LINE_LEN];
+    int line_num = 0;
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_num++;
+
+        // A line too long for the buffer would be read as two
+        bool is_whole = strchr(line, '\n') != NULL || feof(file);
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char *start = line;
+        while (isblank((unsigned char)*start)) {
+            start++;
+        }
+        if (is_whole && (*start == '\0' || *start == '#')) continue;
+
+        ok = is_whole && parse_weight(start, weights);
+        if (!ok) {
+            *out_bad_line = line_num;
+        }
+    }
+
+    fclose(file);
+
+    if (ok) {
+        memcpy(rating_weights, weights, sizeof(weights));
+    }
+    return ok;
+}
+
+// Sets the weight named by line, which must be at most MAX_RATING_WEIGHT.
+// Nothing but blanks may follow the number
+static bool parse_weight(char *line, int weights[NUM_TECHNIQUES]) {
+    char *colon = strchr(line, ':');
+    if (!colon) return false;
+
+    char *name_end = colon;
+    while (name_end > line && isblank((unsigned char)name_end[-1])) {
+        name_end--;
+    }
+    *name_end = '\0';
+
+    int tech = technique_from_full_name(line);
+    if (tech == -1) return false;
+
+    char *end;
+    errno = 0;
+    long weight = strtol(colon + 1, &end, 10);
+    if (end == colon + 1 || errno == ERANGE || weight < 0
+        || weight > MAX_RATING_WEIGHT) {
+        return false;
+    }
+
+    while (isblank((unsigned char)*end)) {
+        end++;
+    }
+    if (*end != '\0') return false;
+
+    weights[tech] = weight;
+    return true;
+}
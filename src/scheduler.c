@@ -0,0 +1,164 @@
+#include "scheduler.h"
+
+#include <stdbool.h>
+
+#include "bits.h"
+#include "cancel.h"
+#include "cell.h"
+#include "grid.h"
+#include "solver.h"
+#include "step.h"
+#include "techniques/registry.h"
+
+static void scheduler_update(Scheduler *sched, Grid *grid);
+static bool scheduler_scope(Scheduler *sched, TechniqueDeps deps,
+                            unsigned int since, SearchScope *out);
+static unsigned int crossing_units(unsigned int units);
+
+void scheduler_init(Scheduler *sched) {
+    sched->gen = 1;
+    for (int i = 0; i < 9; i++) {
+        sched->digit_gens[i] = 1;
+    }
+    for (int i = 0; i < 27; i++) {
+        sched->unit_gens[i] = 1;
+    }
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        sched->fail_gens[i] = 0;
+        sched->costs[i] = (TechniqueCost){0};
+    }
+    for (int i = 0; i < 81; i++) {
+        sched->values[i] = -1;
+        sched->cands[i] = 0;
+    }
+}
+
+SolveStatus scheduler_next_step(Scheduler *sched, Grid *grid, Step *step) {
+    scheduler_update(sched, grid);
+
+    SolveStatus status = SOLVE_STUCK;
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        if (grid_is_solved(grid)) {
+            status = SOLVE_COMPLETE;
+            break;
+        }
+
+        if (!scheduler_scope(sched, techniques[i].deps, sched->fail_gens[i],
+                             &grid->scope)) {
+            continue;
+        }
+        if (grid->scope.digits != ALL_DIGITS
+            || grid->scope.units != ALL_UNITS) {
+            sched->costs[i].scoped++;
+        }
+
+        long long start = cancel_now_ns();
+        bool found = technique_find(&techniques[i], grid, step);
+        sched->costs[i].ns += cancel_now_ns() - start;
+        sched->costs[i].calls++;
+
+        if (found) {
+            status = SOLVE_ONGOING;
+            break;
+        }
+        // A search that was cut short proves nothing, so it isn't recorded
+        if (grid_is_cancelled(grid)) {
+            status = SOLVE_TIMED_OUT;
+            break;
+        }
+        sched->fail_gens[i] = sched->gen;
+    }
+
+    grid->scope = (SearchScope){.digits = ALL_DIGITS, .units = ALL_UNITS};
+    return status;
+}
+
+// A cell whose value or candidates changed touches its three units, every
+// candidate that appeared or disappeared, and its old and new values
+static void scheduler_update(Scheduler *sched, Grid *grid) {
+    unsigned int gen = sched->gen + 1;
+    bool changed = false;
+
+    for (int idx = 0; idx < 81; idx++) {
+        Cell *cell = grid->cells[idx];
+        int old_value = sched->values[idx];
+        unsigned int old_cands = sched->cands[idx];
+
+        if (cell->value == old_value && cell->cands.cands == old_cands) {
+            continue;
+        }
+
+        unsigned int digits = cell->cands.cands ^ old_cands;
+        if (cell->value != old_value) {
+            if (cell->value > 0) digits = SET_BIT(digits, cell->value - 1);
+            if (old_value > 0) digits = SET_BIT(digits, old_value - 1);
+        }
+        for (int d = 0; d < 9; d++) {
+            if (IS_BIT_SET(digits, d)) sched->digit_gens[d] = gen;
+        }
+
+        sched->unit_gens[UNIT_ROW * 9 + cell->row] = gen;
+        sched->unit_gens[UNIT_COL * 9 + cell->col] = gen;
+        sched->unit_gens[UNIT_BOX * 9 + cell->box] = gen;
+
+        sched->values[idx] = cell->value;
+        sched->cands[idx] = cell->cands.cands;
+        changed = true;
+    }
+
+    if (changed) {
+        sched->gen = gen;
+    }
+}
+
+// Sets out to what changed since generation since. Returns false if a
+// technique with the given dependencies can't have a new result
+static bool scheduler_scope(Scheduler *sched, TechniqueDeps deps,
+                            unsigned int since, SearchScope *out) {
+    unsigned int digits = 0;
+    for (int d = 0; d < 9; d++) {
+        if (sched->digit_gens[d] > since) digits = SET_BIT(digits, d);
+    }
+    unsigned int units = 0;
+    for (int u = 0; u < 27; u++) {
+        if (sched->unit_gens[u] > since) units = SET_BIT(units, u);
+    }
+
+    *out = (SearchScope){.digits = ALL_DIGITS, .units = ALL_UNITS};
+
+    switch (deps) {
+    case DEPS_GRID: return sched->gen > since;
+    case DEPS_DIGITS: out->digits = digits; return digits != 0;
+    case DEPS_UNITS: out->units = units; return units != 0;
+    case DEPS_UNITS_AND_CROSSINGS:
+        out->units = units | crossing_units(units);
+        return units != 0;
+    }
+    return true;
+}
+
+// Returns the boxes crossing each line in units and the lines crossing each box
+static unsigned int crossing_units(unsigned int units) {
+    unsigned int crossing = 0;
+
+    for (int i = 0; i < 9; i++) {
+        if (IS_BIT_SET(units, UNIT_ROW * 9 + i)) {
+            for (int j = 0; j < 3; j++) {
+                crossing = SET_BIT(crossing, UNIT_BOX * 9 + (i / 3) * 3 + j);
+            }
+        }
+        if (IS_BIT_SET(units, UNIT_COL * 9 + i)) {
+            for (int j = 0; j < 3; j++) {
+                crossing = SET_BIT(crossing, UNIT_BOX * 9 + j * 3 + i / 3);
+            }
+        }
+        if (IS_BIT_SET(units, UNIT_BOX * 9 + i)) {
+            for (int j = 0; j < 3; j++) {
+                crossing = SET_BIT(crossing, UNIT_ROW * 9 + (i / 3) * 3 + j);
+                crossing = SET_BIT(crossing, UNIT_COL * 9 + (i % 3) * 3 + j);
+            }
+        }
+    }
+
+    return crossing;
+}
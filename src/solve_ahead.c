@@ -0,0 +1,104 @@
+#include "solve_ahead.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "cancel.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "scheduler.h"
+#include "solver.h"
+#include "step.h"
+
+static void *solve_ahead_run(void *arg);
+
+void solve_ahead_start(SolveAhead *ahead, Grid *grid) {
+    pthread_mutex_init(&ahead->lock, NULL);
+    cancel_init(&ahead->cancel, 0, 0);
+    ahead->grid = grid_clone(grid);
+    ahead->grid->cancel = &ahead->cancel;
+    da_init(&ahead->steps);
+    ahead->status = SOLVE_ONGOING;
+    ahead->stop = false;
+
+    pthread_create(&ahead->thread, NULL, solve_ahead_run, ahead);
+}
+
+// Stops the solver thread, cutting short any search it is in, and waits for it
+void solve_ahead_stop(SolveAhead *ahead) {
+    pthread_mutex_lock(&ahead->lock);
+    ahead->stop = true;
+    pthread_mutex_unlock(&ahead->lock);
+    cancel_request(&ahead->cancel);
+
+    pthread_join(ahead->thread, NULL);
+
+    pthread_mutex_destroy(&ahead->lock);
+    grid_destroy(ahead->grid);
+    da_deinit(&ahead->steps);
+}
+
+// Copies step i into out if it has been found already. Otherwise returns false
+// and sets out_status to SOLVE_ONGOING while the solver is still looking for
+// it, or to the final status once the solver has run out of steps
+bool solve_ahead_step(SolveAhead *ahead, int i, Step *out,
+                      SolveStatus *out_status) {
+    pthread_mutex_lock(&ahead->lock);
+
+    bool found = i < ahead->steps.len;
+    if (found) {
+        *out = ahead->steps.elems[i];
+    }
+    *out_status = ahead->status;
+
+    pthread_mutex_unlock(&ahead->lock);
+
+    return found;
+}
+
+// Returns the number of steps found so far
+int solve_ahead_progress(SolveAhead *ahead, SolveStatus *out_status) {
+    pthread_mutex_lock(&ahead->lock);
+
+    int num_steps = ahead->steps.len;
+    *out_status = ahead->status;
+
+    pthread_mutex_unlock(&ahead->lock);
+
+    return num_steps;
+}
+
+static void *solve_ahead_run(void *arg) {
+    SolveAhead *ahead = arg;
+
+    Scheduler sched;
+    scheduler_init(&sched);
+
+    while (true) {
+        Step step;
+        SolveStatus status = scheduler_next_step(&sched, ahead->grid, &step);
+        if (status == SOLVE_ONGOING
+            && !solver_step_is_valid(ahead->grid, &step)) {
+            status = SOLVE_BAD_STEP;
+        }
+
+        pthread_mutex_lock(&ahead->lock);
+
+        // A bad step is still handed out, so it can be looked at
+        if (status == SOLVE_ONGOING || status == SOLVE_BAD_STEP) {
+            da_append(&ahead->steps, step);
+        }
+        if (status != SOLVE_ONGOING) {
+            ahead->status = status;
+        }
+        bool stop = ahead->stop;
+
+        pthread_mutex_unlock(&ahead->lock);
+
+        if (status != SOLVE_ONGOING || stop) break;
+
+        solver_apply_step(ahead->grid, &step);
+    }
+
+    return NULL;
+}
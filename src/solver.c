@@ -1,17 +1,92 @@
 #include "solver.h"
 
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cand_set.h"
+#include "dynarr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "techniques/registry.h"
 
+#define MIN_KEY_SLOTS 64
+
+// What a step does to each cell. Steps with the same key are the same step
+// found twice, for example by two techniques or from two units
+typedef struct {
+    unsigned int hash;
+    unsigned char values[81];
+    unsigned short removals[81];
+} StepKey;
+
+typedef struct {
+    StepKey *elems;
+    int len;
+    int cap;
+} StepKeys;
+
+// The keys of the steps kept so far, indexed by an open-addressing table of
+// their hashes. A slot holds its key's index plus one, or 0 if it's free. The
+// table is kept at most half full
+typedef struct {
+    Steps *steps;
+    StepKeys keys;
+    int *slots;
+    int num_slots;
+} DistinctSteps;
+
+static bool emit_distinct(StepSink *sink, Step *step);
+static int find_key_slot(DistinctSteps *distinct, StepKey *key);
+static void grow_key_slots(DistinctSteps *distinct);
+static void step_key(Step *step, StepKey *out);
+
+bool solver_check_steps = SOLVER_CHECK_STEPS_DEFAULT;
+
+char *solve_status_name(SolveStatus status) {
+    switch (status) {
+    case SOLVE_ONGOING: return "Ongoing";
+    case SOLVE_COMPLETE: return "Solved";
+    case SOLVE_STUCK: return "Stuck";
+    case SOLVE_INVALID: return "Invalid";
+    case SOLVE_TIMED_OUT: return "Timed out";
+    case SOLVE_BAD_STEP: return "Bad step";
+    }
+    return "Unknown";
+}
+
+// Returns SOLVE_TIMED_OUT if the grid's cancel token fires before a step is
+// found. The grid is left as it was
 SolveStatus solver_next_step(Grid *grid, Step *step) {
     for (int i = 0; i < NUM_TECHNIQUES; i++) {
         // for (int i = 0; i < 3; i++) {
         if (grid_is_solved(grid)) return SOLVE_COMPLETE;
-        if (techniques[i](grid, step)) return SOLVE_ONGOING;
+        if (grid_is_cancelled(grid)) return SOLVE_TIMED_OUT;
+        if (technique_find(&techniques[i], grid, step)) return SOLVE_ONGOING;
     }
 
-    return SOLVE_STUCK;
+    return grid_is_cancelled(grid) ? SOLVE_TIMED_OUT : SOLVE_STUCK;
+}
+
+// Appends every distinct step available in grid to out, easiest technique
+// first. A step that places and removes the same candidates as an earlier one
+// is left out, so each is kept under the easiest technique that finds it.
+// Returns the number of steps appended
+int solver_all_steps(Grid *grid, Steps *out) {
+    DistinctSteps distinct = {.steps = out, .slots = NULL, .num_slots = 0};
+    da_init(&distinct.keys);
+    StepSink sink = {.emit = emit_distinct, .data = &distinct, .num_steps = 0};
+
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        techniques[i].find_all(grid, &sink);
+    }
+
+    int num_steps = distinct.keys.len;
+    da_deinit(&distinct.keys);
+    free(distinct.slots);
+    return num_steps;
 }
 
 void solver_apply_step(Grid *grid, Step *step) {
@@ -23,3 +98,85 @@ void solver_revert_step(Grid *grid, Step *step) {
     if (!step) return;
     technique_ops[step->tech].revert(grid, step);
 }
+
+// Checks step against the grid's solution, in time proportional to the
+// number of cells it changes. Steps always pass if checking is off or the
+// solution isn't known
+bool solver_step_is_valid(Grid *grid, Step *step) {
+    if (!solver_check_steps || !grid->has_solution) return true;
+
+    StepEffects effects;
+    effects.len = 0;
+    technique_ops[step->tech].effects(&effects, step);
+    return step_effects_match(&effects, grid->solution);
+}
+
+static bool emit_distinct(StepSink *sink, Step *step) {
+    DistinctSteps *distinct = sink->data;
+
+    if ((distinct->keys.len + 1) * 2 > distinct->num_slots) {
+        grow_key_slots(distinct);
+    }
+
+    StepKey key;
+    step_key(step, &key);
+    int slot = find_key_slot(distinct, &key);
+    if (distinct->slots[slot] != 0) return true;
+
+    da_append(&distinct->keys, key);
+    distinct->slots[slot] = distinct->keys.len;
+    da_append(distinct->steps, *step);
+    return true;
+}
+
+// Returns the slot holding key, or the free slot it would go in
+static int find_key_slot(DistinctSteps *distinct, StepKey *key) {
+    int mask = distinct->num_slots - 1;
+    int slot = key->hash & mask;
+    while (distinct->slots[slot] != 0) {
+        StepKey *other = &distinct->keys.elems[distinct->slots[slot] - 1];
+        if (other->hash == key->hash
+            && memcmp(other, key, sizeof(*key)) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void grow_key_slots(DistinctSteps *distinct) {
+    free(distinct->slots);
+    distinct->num_slots = distinct->num_slots == 0 ? MIN_KEY_SLOTS
+                                                   : distinct->num_slots * 2;
+    distinct->slots = calloc(distinct->num_slots, sizeof(*distinct->slots));
+
+    for (int i = 0; i < distinct->keys.len; i++) {
+        int slot = find_key_slot(distinct, &distinct->keys.elems[i]);
+        distinct->slots[slot] = i + 1;
+    }
+}
+
+static void step_key(Step *step, StepKey *out) {
+    memset(out, 0, sizeof(*out));
+
+    StepEffects effects;
+    effects.len = 0;
+    technique_ops[step->tech].effects(&effects, step);
+    for (int i = 0; i < effects.len; i++) {
+        StepEffect *effect = &effects.elems[i];
+        if (effect->value != 0) {
+            out->values[effect->idx] = effect->value;
+        } else {
+            out->removals[effect->idx] |= effect->cands.cands;
+        }
+    }
+
+    for (int i = 0; i < 81; i++) {
+        out->hash = out->hash * 31 + out->values[i];
+        out->hash = out->hash * 31 + out->removals[i];
+    }
+    // Mixes the high bits into the low ones the table indexes by
+    out->hash ^= out->hash >> 16;
+    out->hash *= 0x45d9f3b;
+    out->hash ^= out->hash >> 16;
+}
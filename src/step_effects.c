@@ -0,0 +1,30 @@
+#include "step_effects.h"
+
+#include <stdbool.h>
+
+#include "cand_set.h"
+
+void step_effects_place(StepEffects *effects, int idx, int value) {
+    effects->elems[effects->len++] = (StepEffect){
+        .idx = idx, .value = value, .cands = cand_set_empty()};
+}
+
+void step_effects_remove(StepEffects *effects, int idx, CandSet cands) {
+    effects->elems[effects->len++] = (StepEffect){
+        .idx = idx, .value = 0, .cands = cands};
+}
+
+// Returns false if a placement differs from the solution or a removal takes
+// away a cell's solution digit
+bool step_effects_match(StepEffects *effects, unsigned char solution[81]) {
+    for (int i = 0; i < effects->len; i++) {
+        StepEffect *effect = &effects->elems[i];
+        int digit = solution[effect->idx];
+
+        if (effect->value != 0 && effect->value != digit) return false;
+        if (effect->value == 0 && cand_set_has(effect->cands, digit)) {
+            return false;
+        }
+    }
+    return true;
+}
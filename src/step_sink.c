@@ -0,0 +1,36 @@
+#include "step_sink.h"
+
+#include <stdbool.h>
+
+#include "dynarr.h"
+#include "step.h"
+
+static bool emit_first(StepSink *sink, Step *step);
+static bool emit_all(StepSink *sink, Step *step);
+
+// Keeps the first step in out and stops the search there
+StepSink step_sink_first(Step *out) {
+    return (StepSink){.emit = emit_first, .data = out, .num_steps = 0};
+}
+
+// Appends every step to out
+StepSink step_sink_all(Steps *out) {
+    return (StepSink){.emit = emit_all, .data = out, .num_steps = 0};
+}
+
+// Returns false if the search should stop
+bool step_sink_emit(StepSink *sink, Step *step) {
+    sink->num_steps++;
+    return sink->emit(sink, step);
+}
+
+static bool emit_first(StepSink *sink, Step *step) {
+    *(Step *)sink->data = *step;
+    return false;
+}
+
+static bool emit_all(StepSink *sink, Step *step) {
+    Steps *steps = sink->data;
+    da_append(steps, *step);
+    return true;
+}
@@ -0,0 +1,304 @@
+#include "techniques/aic.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "links.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+
+// A state is a node that the chain has made false (off) or true (on). Strong
+// links lead from off to on and weak links from on to off
+#define NUM_STATES (2 * NUM_NODES)
+#define STATE(node, on) ((node) * 2 + (on))
+#define STATE_NODE(state) ((state) / 2)
+#define STATE_IS_ON(state) ((state) % 2)
+
+// A breadth-first search from one start node, which is off. visited holds the
+// states seen so far, as the cells of each digit, so a weak link step only
+// looks at peers it hasn't reached yet. parent and num_links give the chain
+// back to the start from any state reached
+typedef struct {
+    Grid *grid;
+    LinkGraph *links;
+    Bitboard cands[9];
+    Bitboard visited[2][9];
+    short parent[NUM_STATES];
+    unsigned char num_links[NUM_STATES];
+    short queue[NUM_STATES];
+    int queue_len;
+} ChainSearch;
+
+static void search_init(ChainSearch *search, Grid *grid);
+static int search_from(ChainSearch *search, int start, ChainStep *chain);
+static bool visit(ChainSearch *search, int state, int parent);
+static int chain_removals(ChainSearch *search, int start, int end,
+                          short out[MAX_CHAIN_REMOVALS]);
+static int build_chain(ChainSearch *search, int end_state, ChainStep *chain);
+static void print_node(DynStr *ds, int node);
+
+// Finds the shortest productive chain from every start first, so that steps
+// come out shortest first and the search from each start stops at its first
+// chain. Only the chains that get emitted are searched again to rebuild them
+bool aic(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_AIC};
+    ChainSearch search;
+    search_init(&search, grid);
+
+    unsigned char lengths[NUM_NODES];
+    for (int start = 0; start < NUM_NODES; start++) {
+        lengths[start] = 0;
+        if (!links_has_node(search.links, start)) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        lengths[start] = search_from(&search, start, &step.as.chain);
+    }
+
+    for (int length = 2; length <= MAX_CHAIN_NODES; length += 2) {
+        for (int start = 0; start < NUM_NODES; start++) {
+            if (lengths[start] != length) continue;
+
+            search_from(&search, start, &step.as.chain);
+            if (!step_sink_emit(sink, &step)) return false;
+        }
+    }
+
+    return true;
+}
+
+void aic_apply(Grid *grid, Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        int node = s->removals[i];
+        cell_remove_cand(grid->cells[NODE_IDX(node)], NODE_DIGIT(node));
+    }
+}
+
+void aic_revert(Grid *grid, Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        int node = s->removals[i];
+        cell_add_cand(grid->cells[NODE_IDX(node)], NODE_DIGIT(node));
+    }
+}
+
+void aic_explain(DynStr *ds, Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    ds_append(ds, "[AIC] ");
+    for (int i = 0; i < s->num_nodes; i++) {
+        if (i > 0) {
+            ds_append(ds, i % 2 == 1 ? " = " : " - ");
+        }
+        print_node(ds, s->nodes[i]);
+    }
+    ds_append(ds, ":\n");
+
+    for (int i = 0; i < s->num_removals; i++) {
+        int node = s->removals[i];
+        int row = ROW_FROM_IDX(NODE_IDX(node));
+        int col = COL_FROM_IDX(NODE_IDX(node));
+
+        ds_appendf(ds, "- Removed {%d} from r%dc%d\n", NODE_DIGIT(node),
+                   row + 1, col + 1);
+    }
+}
+
+void aic_colorise(ColorPair colors[81][9], Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    for (int i = 0; i < s->num_nodes; i++) {
+        int node = s->nodes[i];
+        colors[NODE_IDX(node)][NODE_DIGIT(node) - 1] = i % 2 == 0
+                                                           ? CP_SPECIAL
+                                                           : CP_TRIGGER;
+    }
+    for (int i = 0; i < s->num_removals; i++) {
+        int node = s->removals[i];
+        colors[NODE_IDX(node)][NODE_DIGIT(node) - 1] = CP_REMOVAL;
+    }
+}
+
+void aic_encode(Bytes *out, Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    encode_uint(out, s->num_nodes);
+    for (int i = 0; i < s->num_nodes; i++) {
+        encode_uint(out, s->nodes[i]);
+    }
+    encode_uint(out, s->num_removals);
+    for (int i = 0; i < s->num_removals; i++) {
+        encode_uint(out, s->removals[i]);
+    }
+}
+
+void aic_decode(Decoder *in, Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    s->num_nodes = decode_max(in, MAX_CHAIN_NODES);
+    for (int i = 0; i < s->num_nodes; i++) {
+        s->nodes[i] = decode_node(in);
+    }
+    s->num_removals = decode_max(in, MAX_CHAIN_REMOVALS);
+    for (int i = 0; i < s->num_removals; i++) {
+        s->removals[i] = decode_node(in);
+    }
+}
+
+void aic_effects(StepEffects *out, Step *step) {
+    ChainStep *s = &step->as.chain;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        int node = s->removals[i];
+        step_effects_remove(out, NODE_IDX(node),
+                            cand_set_from_values(1, NODE_DIGIT(node)));
+    }
+}
+
+static void search_init(ChainSearch *search, Grid *grid) {
+    search->grid = grid;
+    search->links = grid_links(grid);
+    for (int digit = 1; digit <= 9; digit++) {
+        search->cands[digit - 1] = grid_cells_with_cand(grid, digit);
+    }
+}
+
+// Returns the number of nodes in the shortest chain from start that removes
+// something, and stores it in chain, or returns 0 if there's none
+static int search_from(ChainSearch *search, int start, ChainStep *chain) {
+    Grid *grid = search->grid;
+    memset(search->visited, 0, sizeof(search->visited));
+    search->queue_len = 0;
+
+    visit(search, STATE(start, 0), -1);
+    // Reaching the start again would be a loop, not a chain
+    bb_add(&search->visited[1][NODE_DIGIT(start) - 1], NODE_IDX(start));
+
+    for (int head = 0; head < search->queue_len; head++) {
+        int state = search->queue[head];
+        int node = STATE_NODE(state);
+
+        if (!STATE_IS_ON(state)) {
+            for (int kind = 0; kind < NUM_LINK_KINDS; kind++) {
+                int partner = search->links->strong[node][kind];
+                if (partner == NO_LINK) continue;
+                if (!visit(search, STATE(partner, 1), state)) continue;
+
+                chain->num_removals = chain_removals(search, start, partner,
+                                                     chain->removals);
+                if (chain->num_removals > 0) {
+                    return build_chain(search, STATE(partner, 1), chain);
+                }
+            }
+            continue;
+        }
+
+        // A weak and a strong link more must still fit
+        if (search->num_links[state] + 3 > MAX_CHAIN_NODES) continue;
+
+        int idx = NODE_IDX(node);
+        int digit = NODE_DIGIT(node);
+
+        Bitboard peers = bb_and_not(
+            bb_and(search->cands[digit - 1], grid->peer_masks[idx]),
+            search->visited[0][digit - 1]);
+        int peer_idxs[NUM_PEERS];
+        int num_peers = bb_to_idxs(peers, peer_idxs);
+        for (int i = 0; i < num_peers; i++) {
+            visit(search, STATE(NODE(peer_idxs[i], digit), 0), state);
+        }
+
+        int cands[9];
+        int num_cands = cand_set_to_arr(grid->cells[idx]->cands, cands);
+        for (int i = 0; i < num_cands; i++) {
+            if (cands[i] == digit) continue;
+            visit(search, STATE(NODE(idx, cands[i]), 0), state);
+        }
+    }
+
+    return 0;
+}
+
+// Queues state unless it has been seen. Returns whether it was new
+static bool visit(ChainSearch *search, int state, int parent) {
+    int node = STATE_NODE(state);
+    Bitboard *visited = &search->visited[STATE_IS_ON(state)]
+                                        [NODE_DIGIT(node) - 1];
+    if (bb_has(*visited, NODE_IDX(node))) return false;
+
+    bb_add(visited, NODE_IDX(node));
+    search->parent[state] = parent;
+    search->num_links[state] = parent == -1 ? 0
+                                            : search->num_links[parent] + 1;
+    search->queue[search->queue_len++] = state;
+    return true;
+}
+
+// One of start and end is true, so every candidate seeing both goes
+static int chain_removals(ChainSearch *search, int start, int end,
+                          short out[MAX_CHAIN_REMOVALS]) {
+    Grid *grid = search->grid;
+    int start_idx = NODE_IDX(start);
+    int end_idx = NODE_IDX(end);
+    int start_digit = NODE_DIGIT(start);
+    int end_digit = NODE_DIGIT(end);
+    int num_removals = 0;
+
+    if (start_digit == end_digit) {
+        Bitboard removals = bb_and(
+            search->cands[start_digit - 1],
+            bb_and(grid->peer_masks[start_idx], grid->peer_masks[end_idx]));
+        int idxs[MAX_COMMON_PEERS];
+        int num_idxs = bb_to_idxs(removals, idxs);
+        for (int i = 0; i < num_idxs; i++) {
+            out[num_removals++] = NODE(idxs[i], start_digit);
+        }
+    } else if (start_idx == end_idx) {
+        int cands[9];
+        int num_cands = cand_set_to_arr(grid->cells[start_idx]->cands, cands);
+        for (int i = 0; i < num_cands; i++) {
+            if (cands[i] == start_digit || cands[i] == end_digit) continue;
+            out[num_removals++] = NODE(start_idx, cands[i]);
+        }
+    } else {
+        int nodes[2] = {NODE(start_idx, end_digit), NODE(end_idx, start_digit)};
+        for (int i = 0; i < 2; i++) {
+            if (!links_has_node(search->links, nodes[i])) continue;
+            if (!links_sees(nodes[i], start) || !links_sees(nodes[i], end)) {
+                continue;
+            }
+            out[num_removals++] = nodes[i];
+        }
+    }
+
+    return num_removals;
+}
+
+static int build_chain(ChainSearch *search, int end_state, ChainStep *chain) {
+    chain->num_nodes = search->num_links[end_state] + 1;
+
+    int state = end_state;
+    for (int i = chain->num_nodes - 1; i >= 0; i--) {
+        chain->nodes[i] = STATE_NODE(state);
+        state = search->parent[state];
+    }
+
+    return chain->num_nodes;
+}
+
+static void print_node(DynStr *ds, int node) {
+    int row = ROW_FROM_IDX(NODE_IDX(node));
+    int col = COL_FROM_IDX(NODE_IDX(node));
+
+    ds_appendf(ds, "{%d}r%dc%d", NODE_DIGIT(node), row + 1, col + 1);
+}
@@ -0,0 +1,189 @@
+#include "techniques/als_xz.h"
+
+#include <stdbool.h>
+
+#include "als.h"
+#include "bitboard.h"
+#include "bits.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynarr.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+static bool als_pair(Bitboard cands[9], Als *a, Als *b, Step *step,
+                     StepSink *sink);
+static void print_als(DynStr *ds, Bitboard cells, CandSet cands);
+
+bool als_xz(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_ALS_XZ};
+    Alses alses;
+    da_init(&alses);
+    als_collect(grid_als(grid), grid->peer_masks, &alses);
+
+    Bitboard cands[9];
+    for (int digit = 1; digit <= 9; digit++) {
+        cands[digit - 1] = grid_cells_with_cand(grid, digit);
+    }
+
+    bool should_continue = true;
+    for (int i = 0; i < alses.len && should_continue; i++) {
+        should_continue = !grid_is_cancelled(grid);
+        for (int j = i + 1; j < alses.len && should_continue; j++) {
+            should_continue = als_pair(cands, &alses.elems[i],
+                                       &alses.elems[j], &step, sink);
+        }
+    }
+
+    da_deinit(&alses);
+    return should_continue;
+}
+
+void als_xz_apply(Grid *grid, Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_remove_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void als_xz_revert(Grid *grid, Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_add_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void als_xz_explain(DynStr *ds, Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    ds_append(ds, "[ALS-XZ] ");
+    print_als(ds, s->cells[0], s->cands[0]);
+    ds_append(ds, " and ");
+    print_als(ds, s->cells[1], s->cands[1]);
+    ds_appendf(ds, ", restricted on {%d}:\n", s->x);
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        int row = ROW_FROM_IDX(idxs[i]);
+        int col = COL_FROM_IDX(idxs[i]);
+
+        ds_appendf(ds, "- Removed {%d} from r%dc%d\n", s->value, row + 1,
+                   col + 1);
+    }
+}
+
+void als_xz_colorise(ColorPair colors[81][9], Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    for (int i = 0; i < 2; i++) {
+        int idxs[81];
+        int num_idxs = bb_to_idxs(s->cells[i], idxs);
+        for (int j = 0; j < num_idxs; j++) {
+            for (int cand = 1; cand <= 9; cand++) {
+                if (!cand_set_has(s->cands[i], cand)) continue;
+                colors[idxs[j]][cand - 1] = cand == s->x ? CP_SPECIAL
+                                                         : CP_TRIGGER;
+            }
+        }
+    }
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_REMOVAL;
+    }
+}
+
+void als_xz_encode(Bytes *out, Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    for (int i = 0; i < 2; i++) {
+        encode_bitboard(out, s->cells[i]);
+        encode_cand_set(out, s->cands[i]);
+    }
+    encode_uint(out, s->x);
+    encode_uint(out, s->value);
+    encode_bitboard(out, s->removals);
+}
+
+void als_xz_decode(Decoder *in, Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    for (int i = 0; i < 2; i++) {
+        s->cells[i] = decode_bitboard(in);
+        s->cands[i] = decode_cand_set(in);
+    }
+    s->x = decode_digit(in);
+    s->value = decode_digit(in);
+    s->removals = decode_bitboard(in);
+}
+
+void als_xz_effects(StepEffects *out, Step *step) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    CandSet cands = cand_set_from_values(1, s->value);
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        step_effects_remove(out, idxs[i], cands);
+    }
+}
+
+// Emits a step for every restricted common x of a and b and every other digit
+// they share. x is restricted when each copy of it in b sees every copy in a,
+// which the peer masks in a->sees answer at once
+static bool als_pair(Bitboard cands[9], Als *a, Als *b, Step *step,
+                     StepSink *sink) {
+    AlsXzStep *s = &step->as.als_xz;
+
+    unsigned int common = a->cands & b->cands;
+    if (__builtin_popcount(common) < 2) return true;
+    if (!bb_is_empty(bb_and(a->cells, b->cells))) return true;
+
+    for (int x = 1; x <= 9; x++) {
+        if (!IS_BIT_SET(common, x - 1)) continue;
+        if (!bb_is_empty(bb_and_not(b->cells_with[x - 1], a->sees[x - 1]))) {
+            continue;
+        }
+
+        for (int z = 1; z <= 9; z++) {
+            if (z == x || !IS_BIT_SET(common, z - 1)) continue;
+
+            Bitboard removals = bb_and(
+                cands[z - 1], bb_and(a->sees[z - 1], b->sees[z - 1]));
+            if (bb_is_empty(removals)) continue;
+
+            s->cells[0] = a->cells;
+            s->cells[1] = b->cells;
+            s->cands[0] = cand_set_from_mask(a->cands);
+            s->cands[1] = cand_set_from_mask(b->cands);
+            s->x = x;
+            s->value = z;
+            s->removals = removals;
+            if (!step_sink_emit(sink, step)) return false;
+        }
+    }
+
+    return true;
+}
+
+static void print_als(DynStr *ds, Bitboard cells, CandSet cands) {
+    int idxs[81];
+    int num_idxs = bb_to_idxs(cells, idxs);
+    print_cand_set(ds, cands);
+    ds_append(ds, " in ");
+    print_idxs(ds, idxs, num_idxs);
+}
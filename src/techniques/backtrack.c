@@ -1,72 +1,153 @@
 #include "techniques/backtrack.h"
 
 #include <stdbool.h>
+#include <string.h>
 
+#include "bits.h"
+#include "cancel.h"
 #include "cell.h"
 #include "grid.h"
 
-static int cells_with_value(Cell *cells[], int num_cells, int value);
-static bool is_placement_valid(Grid *grid, int idx, int value);
+// Tracks the digits used in every unit, so the options of a cell are a couple
+// of mask operations instead of a scan of its peers
+typedef struct {
+    int values[81];
+    unsigned int rows[9];
+    unsigned int cols[9];
+    unsigned int boxes[9];
+    int num_solutions;
+    unsigned char *solution;
+    CancelToken *cancel;
+} Search;
+
+static bool search_place(Search *search, int idx, int value);
+static void search_unplace(Search *search, int idx, int value);
+static unsigned int search_options(Search *search, int idx);
+static void search_solve(Search *search);
+
+// Counts the solutions of the grid's placed values, stopping at two. The first
+// solution found is written to out_solution unless it is NULL. Returns
+// BACKTRACK_CANCELLED if the grid's cancel token fires first. The grid itself
+// isn't modified
+int backtrack(Grid *grid, unsigned char out_solution[81]) {
+    int values[81];
+    for (int i = 0; i < 81; i++) {
+        values[i] = grid->cells[i]->value;
+    }
+    return backtrack_values(values, out_solution, grid->cancel);
+}
 
-int backtrack(Grid *grid) {
-    int num_empty = 0;
-    int empty_idxs[81];
+// cancel may be NULL
+int backtrack_values(int values[81], unsigned char out_solution[81],
+                     CancelToken *cancel) {
+    Search search = {.solution = out_solution, .cancel = cancel};
 
     for (int i = 0; i < 81; i++) {
-        if (cell_is_empty(grid->cells[i])) {
-            empty_idxs[num_empty++] = i;
-        }
+        if (values[i] != 0 && !search_place(&search, i, values[i])) return 0;
     }
 
-    int solutions = 0;
+    search_solve(&search);
+    if (cancel && cancel_is_cancelled(cancel)) return BACKTRACK_CANCELLED;
+    return search.num_solutions;
+}
 
-    int curr = 0;
-    while (true) {
-        int idx = empty_idxs[curr];
-        Cell *cell = grid->cells[idx];
+static bool search_place(Search *search, int idx, int value) {
+    unsigned int bit = BIT(value - 1);
+    if (!(search_options(search, idx) & bit)) return false;
 
-        if (cell->value == 9) {
-            if (curr == 0) break;
+    search->values[idx] = value;
+    search->rows[ROW_FROM_IDX(idx)] |= bit;
+    search->cols[COL_FROM_IDX(idx)] |= bit;
+    search->boxes[BOX_FROM_IDX(idx)] |= bit;
+    return true;
+}
 
-            cell->value = 0;
-            curr--;
-            continue;
-        }
+static void search_unplace(Search *search, int idx, int value) {
+    unsigned int bit = BIT(value - 1);
 
-        cell->value++;
-        if (!is_placement_valid(grid, idx, cell->value)) continue;
+    search->values[idx] = 0;
+    search->rows[ROW_FROM_IDX(idx)] &= ~bit;
+    search->cols[COL_FROM_IDX(idx)] &= ~bit;
+    search->boxes[BOX_FROM_IDX(idx)] &= ~bit;
+}
 
-        if (curr == num_empty - 1) {
-            solutions++;
-            if (solutions > 1) break;
-            continue;
-        }
+static unsigned int search_options(Search *search, int idx) {
+    unsigned int used = search->rows[ROW_FROM_IDX(idx)]
+                      | search->cols[COL_FROM_IDX(idx)]
+                      | search->boxes[BOX_FROM_IDX(idx)];
+    return ~used & ALL_DIGITS;
+}
 
-        curr++;
+// Branches on the empty cell with the fewest options, unless some digit has
+// only one place left in a unit. Either keeps the search tree small, and both
+// find dead ends (a cell or a digit with nowhere to go) straight away
+static void search_solve(Search *search) {
+    if (search->cancel && cancel_check(search->cancel)) return;
+
+    unsigned int options[81];
+    int best_idx = -1;
+    int best_count = 10;
+
+    for (int idx = 0; idx < 81; idx++) {
+        if (search->values[idx] != 0) continue;
+
+        options[idx] = search_options(search, idx);
+        int count = count_ones(options[idx]);
+        if (count == 0) return;
+        if (count < best_count) {
+            best_idx = idx;
+            best_count = count;
+        }
     }
 
-    for (int i = 0; i < num_empty; i++) {
-        grid->cells[empty_idxs[i]]->value = 0;
+    if (best_idx == -1) {
+        if (search->num_solutions == 0 && search->solution != NULL) {
+            for (int i = 0; i < 81; i++) {
+                search->solution[i] = search->values[i];
+            }
+        }
+        search->num_solutions++;
+        return;
     }
 
-    return solutions;
-}
+    unsigned int best_options = options[best_idx];
+    for (int unit = 0; unit < 27 && best_count > 1; unit++) {
+        unsigned int *used = unit < 9    ? search->rows
+                           : unit < 18 ? search->cols
+                                       : search->boxes;
+        unsigned int missing = ~used[unit % 9] & ALL_DIGITS;
+        unsigned int once = 0;
+        unsigned int twice = 0;
+
+        for (int i = 0; i < 9; i++) {
+            int idx = IDX_FROM_UNIT(unit, i);
+            if (search->values[idx] != 0) continue;
+            twice |= once & options[idx];
+            once |= options[idx];
+        }
 
-static int cells_with_value(Cell *cells[], int num_cells, int value) {
-    int count = 0;
-    for (int i = 0; i < num_cells; i++) {
-        if (cells[i]->value == value) {
-            count++;
+        if (missing & ~once) return;
+
+        unsigned int singles = once & ~twice;
+        if (singles == 0) continue;
+
+        unsigned int single = singles & -singles;
+        for (int i = 0; i < 9; i++) {
+            int idx = IDX_FROM_UNIT(unit, i);
+            if (search->values[idx] == 0 && options[idx] & single) {
+                best_idx = idx;
+                best_options = single;
+                best_count = 1;
+                break;
+            }
         }
     }
-    return count;
-}
 
-static bool is_placement_valid(Grid *grid, int idx, int value) {
-    Cell *cell = grid->cells[idx];
+    for (int value = 1; value <= 9 && search->num_solutions < 2; value++) {
+        if (!IS_BIT_SET(best_options, value - 1)) continue;
 
-    if (cells_with_value(grid->rows[cell->row], 9, value) > 1) return false;
-    if (cells_with_value(grid->cols[cell->col], 9, value) > 1) return false;
-    if (cells_with_value(grid->boxes[cell->box], 9, value) > 1) return false;
-    return true;
+        search_place(search, best_idx, value);
+        search_solve(search);
+        search_unplace(search, best_idx, value);
+    }
 }
@@ -0,0 +1,160 @@
+#include "techniques/bug.h"
+
+#include <stdbool.h>
+
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+static int find_trivalue(Grid *grid);
+static int find_value(Grid *grid, int idx, int counts[27][9]);
+static bool is_bug(int idx, int value, int counts[27][9]);
+
+// Without the extra candidate of the one trivalue cell, every empty cell would
+// be bivalue and every candidate would appear twice in each of its units. That
+// pattern always has two solutions, so on a puzzle known to have one the cell
+// must be the candidate that appears three times
+bool bug_plus_1(Grid *grid, StepSink *sink) {
+    if (!grid->has_solution) return true;
+
+    int idx = find_trivalue(grid);
+    if (idx == -1) return true;
+
+    int counts[27][9] = {0};
+    for (int i = 0; i < 81; i++) {
+        Cell *cell = grid->cells[i];
+        int units[3] = {cell->row, 9 + cell->col, 18 + cell->box};
+        for (int digit = 1; digit <= 9; digit++) {
+            if (!cell_has_cand(cell, digit)) continue;
+            for (int j = 0; j < 3; j++) {
+                counts[units[j]][digit - 1]++;
+            }
+        }
+    }
+
+    int value = find_value(grid, idx, counts);
+    if (value == 0 || !grid_digit_in_scope(grid, value)) return true;
+    if (!is_bug(idx, value, counts)) return true;
+
+    Step step = {.tech = TECH_BUG_PLUS_1};
+    BugStep *s = &step.as.bug;
+    s->idx = idx;
+    s->value = value;
+    s->removed_cands = grid->cells[idx]->cands;
+    cand_set_remove(&s->removed_cands, value);
+
+    return step_sink_emit(sink, &step);
+}
+
+void bug_apply(Grid *grid, Step *step) {
+    BugStep *s = &step->as.bug;
+
+    cell_remove_cands(grid->cells[s->idx], s->removed_cands);
+}
+
+void bug_revert(Grid *grid, Step *step) {
+    BugStep *s = &step->as.bug;
+
+    cell_add_cands(grid->cells[s->idx], s->removed_cands);
+}
+
+void bug_explain(DynStr *ds, Step *step) {
+    BugStep *s = &step->as.bug;
+    int row = ROW_FROM_IDX(s->idx);
+    int col = COL_FROM_IDX(s->idx);
+
+    ds_appendf(ds, "[BUG+1] Every other empty cell is bivalue, so r%dc%d is "
+                   "{%d}:\n",
+               row + 1, col + 1, s->value);
+    ds_append(ds, "- Removed ");
+    print_cand_set(ds, s->removed_cands);
+    ds_appendf(ds, " from r%dc%d\n", row + 1, col + 1);
+}
+
+void bug_colorise(ColorPair colors[81][9], Step *step) {
+    BugStep *s = &step->as.bug;
+
+    colors[s->idx][s->value - 1] = CP_SPECIAL;
+    for (int cand = 1; cand <= 9; cand++) {
+        if (cand_set_has(s->removed_cands, cand)) {
+            colors[s->idx][cand - 1] = CP_REMOVAL;
+        }
+    }
+}
+
+void bug_encode(Bytes *out, Step *step) {
+    BugStep *s = &step->as.bug;
+
+    encode_uint(out, s->idx);
+    encode_uint(out, s->value);
+    encode_cand_set(out, s->removed_cands);
+}
+
+void bug_decode(Decoder *in, Step *step) {
+    BugStep *s = &step->as.bug;
+
+    s->idx = decode_idx(in);
+    s->value = decode_digit(in);
+    s->removed_cands = decode_cand_set(in);
+}
+
+void bug_effects(StepEffects *out, Step *step) {
+    BugStep *s = &step->as.bug;
+
+    step_effects_place(out, s->idx, s->value);
+}
+
+// The only empty cell with three candidates, or -1 if there isn't exactly one
+// and every other empty cell bivalue
+static int find_trivalue(Grid *grid) {
+    int idx = -1;
+    for (int i = 0; i < 81; i++) {
+        int len = grid->cells[i]->cands.len;
+        if (grid->cells[i]->value != 0 || len == 2) continue;
+        if (len != 3 || idx != -1) return -1;
+        idx = i;
+    }
+    return idx;
+}
+
+static int find_value(Grid *grid, int idx, int counts[27][9]) {
+    Cell *cell = grid->cells[idx];
+    int units[3] = {cell->row, 9 + cell->col, 18 + cell->box};
+
+    for (int digit = 1; digit <= 9; digit++) {
+        if (!cell_has_cand(cell, digit)) continue;
+
+        bool is_three = true;
+        for (int j = 0; j < 3; j++) {
+            is_three = is_three && counts[units[j]][digit - 1] == 3;
+        }
+        if (is_three) return digit;
+    }
+    return 0;
+}
+
+static bool is_bug(int idx, int value, int counts[27][9]) {
+    int units[3] = {ROW_FROM_IDX(idx), 9 + COL_FROM_IDX(idx),
+                    18 + BOX_FROM_IDX(idx)};
+
+    for (int unit = 0; unit < 27; unit++) {
+        bool is_special = unit == units[0] || unit == units[1]
+                          || unit == units[2];
+        for (int digit = 1; digit <= 9; digit++) {
+            int count = counts[unit][digit - 1];
+            if (is_special && digit == value) {
+                if (count != 3) return false;
+            } else if (count != 0 && count != 2) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,323 @@
+#include "techniques/coloring.h"
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "links.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+// Every cluster has at least two cells
+#define MAX_CLUSTERS 40
+
+// The two colors of a cluster and the cells that see each of them
+typedef struct {
+    Bitboard colors[2];
+    Bitboard sees[2];
+} Cluster;
+
+typedef struct {
+    Cluster elems[MAX_CLUSTERS];
+    int len;
+} Clusters;
+
+static void build_clusters(Grid *grid, int digit, Clusters *clusters);
+static int uf_find(int parent[81], unsigned char parity[81], int idx);
+static void uf_union(int parent[81], unsigned char parity[81], int a, int b);
+static void print_color(DynStr *ds, Bitboard color);
+
+bool simple_coloring(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_SIMPLE_COLORING};
+    ColoringStep *s = &step.as.coloring;
+    s->num_clusters = 1;
+
+    for (int digit = 1; digit <= 9; digit++) {
+        if (!grid_digit_in_scope(grid, digit)) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        Clusters clusters;
+        build_clusters(grid, digit, &clusters);
+        Bitboard cands = grid_cells_with_cand(grid, digit);
+        s->value = digit;
+
+        for (int i = 0; i < clusters.len; i++) {
+            Cluster *c = &clusters.elems[i];
+
+            // Two cells of one color see each other, so that color is false
+            for (int k = 0; k < 2; k++) {
+                if (bb_is_empty(bb_and(c->colors[k], c->sees[k]))) continue;
+
+                s->colors[0] = c->colors[k];
+                s->colors[1] = c->colors[1 - k];
+                s->is_wrap = true;
+                s->removals = c->colors[k];
+                if (!step_sink_emit(sink, &step)) return false;
+            }
+
+            // One of the colors is true, so the digit goes from cells that
+            // see both
+            Bitboard removals = bb_and(cands, bb_and(c->sees[0], c->sees[1]));
+            if (bb_is_empty(removals)) continue;
+
+            s->colors[0] = c->colors[0];
+            s->colors[1] = c->colors[1];
+            s->is_wrap = false;
+            s->removals = removals;
+            if (!step_sink_emit(sink, &step)) return false;
+        }
+    }
+
+    return true;
+}
+
+bool multi_coloring(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_MULTI_COLORING};
+    ColoringStep *s = &step.as.coloring;
+    s->num_clusters = 2;
+
+    for (int digit = 1; digit <= 9; digit++) {
+        if (!grid_digit_in_scope(grid, digit)) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        Clusters clusters;
+        build_clusters(grid, digit, &clusters);
+        Bitboard cands = grid_cells_with_cand(grid, digit);
+        s->value = digit;
+
+        for (int i = 0; i < clusters.len; i++) {
+            for (int j = 0; j < clusters.len; j++) {
+                if (i == j) continue;
+                Cluster *a = &clusters.elems[i];
+                Cluster *b = &clusters.elems[j];
+
+                for (int ka = 0; ka < 2; ka++) {
+                    s->colors[0] = a->colors[ka];
+                    s->colors[1] = a->colors[1 - ka];
+
+                    // A color seeing both colors of another cluster is false
+                    if (!bb_is_empty(bb_and(a->colors[ka], b->sees[0]))
+                        && !bb_is_empty(bb_and(a->colors[ka], b->sees[1]))) {
+                        s->colors[2] = b->colors[0];
+                        s->colors[3] = b->colors[1];
+                        s->is_wrap = true;
+                        s->removals = a->colors[ka];
+                        if (!step_sink_emit(sink, &step)) return false;
+                    }
+
+                    // Colors seeing each other can't both be true, so one of
+                    // their opposites is. Each pair is only tried one way
+                    if (j < i) continue;
+                    for (int kb = 0; kb < 2; kb++) {
+                        if (bb_is_empty(bb_and(a->colors[ka], b->sees[kb]))) {
+                            continue;
+                        }
+
+                        Bitboard removals = bb_and(
+                            cands, bb_and(a->sees[1 - ka], b->sees[1 - kb]));
+                        if (bb_is_empty(removals)) continue;
+
+                        s->colors[2] = b->colors[kb];
+                        s->colors[3] = b->colors[1 - kb];
+                        s->is_wrap = false;
+                        s->removals = removals;
+                        if (!step_sink_emit(sink, &step)) return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void coloring_apply(Grid *grid, Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_remove_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void coloring_revert(Grid *grid, Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_add_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void coloring_explain(DynStr *ds, Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    ds_appendf(ds, "[%s] Color %s on {%d} with colors ",
+               s->num_clusters == 1 ? "Simple Coloring" : "Multi-Coloring",
+               s->is_wrap ? "wrap" : "trap", s->value);
+    print_color(ds, s->colors[0]);
+    ds_append(ds, " and ");
+    print_color(ds, s->colors[1]);
+    if (s->num_clusters == 2) {
+        ds_append(ds, ", and ");
+        print_color(ds, s->colors[2]);
+        ds_append(ds, " and ");
+        print_color(ds, s->colors[3]);
+    }
+    ds_append(ds, ":\n");
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        int row = ROW_FROM_IDX(idxs[i]);
+        int col = COL_FROM_IDX(idxs[i]);
+
+        ds_appendf(ds, "- Removed {%d} from r%dc%d\n", s->value, row + 1,
+                   col + 1);
+    }
+}
+
+// The first color of each cluster is the one the step reasons from
+void coloring_colorise(ColorPair colors[81][9], Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    for (int i = 0; i < 2 * s->num_clusters; i++) {
+        int idxs[81];
+        int num_idxs = bb_to_idxs(s->colors[i], idxs);
+        for (int j = 0; j < num_idxs; j++) {
+            colors[idxs[j]][s->value - 1] = i % 2 == 0 ? CP_SPECIAL
+                                                       : CP_TRIGGER;
+        }
+    }
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_REMOVAL;
+    }
+}
+
+void coloring_encode(Bytes *out, Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    encode_uint(out, s->value);
+    encode_uint(out, s->is_wrap);
+    for (int i = 0; i < 2 * s->num_clusters; i++) {
+        encode_bitboard(out, s->colors[i]);
+    }
+    encode_bitboard(out, s->removals);
+}
+
+void coloring_decode(Decoder *in, Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    s->num_clusters = step->tech == TECH_SIMPLE_COLORING ? 1 : 2;
+    s->value = decode_digit(in);
+    s->is_wrap = decode_max(in, 1);
+    for (int i = 0; i < 2 * s->num_clusters; i++) {
+        s->colors[i] = decode_bitboard(in);
+    }
+    s->removals = decode_bitboard(in);
+}
+
+void coloring_effects(StepEffects *out, Step *step) {
+    ColoringStep *s = &step->as.coloring;
+
+    CandSet cands = cand_set_from_values(1, s->value);
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        step_effects_remove(out, idxs[i], cands);
+    }
+}
+
+// Joins the two ends of every conjugate pair on digit with a union-find that
+// also tracks whether each cell has its root's color. A single pass over the
+// cells then sorts them into clusters and colors
+static void build_clusters(Grid *grid, int digit, Clusters *clusters) {
+    LinkGraph *links = grid_links(grid);
+    int parent[81];
+    unsigned char parity[81];
+    Bitboard linked = bb_empty();
+
+    for (int idx = 0; idx < 81; idx++) {
+        parent[idx] = idx;
+        parity[idx] = 0;
+    }
+
+    for (int idx = 0; idx < 81; idx++) {
+        int node = NODE(idx, digit);
+        if (!links_has_node(links, node)) continue;
+
+        for (int kind = LINK_ROW; kind <= LINK_BOX; kind++) {
+            int partner = links->strong[node][kind];
+            if (partner == NO_LINK) continue;
+
+            bb_add(&linked, idx);
+            uf_union(parent, parity, idx, NODE_IDX(partner));
+        }
+    }
+
+    int cluster_of[81];
+    for (int idx = 0; idx < 81; idx++) {
+        cluster_of[idx] = -1;
+    }
+
+    clusters->len = 0;
+    int idxs[81];
+    int num_idxs = bb_to_idxs(linked, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        int idx = idxs[i];
+        int root = uf_find(parent, parity, idx);
+
+        if (cluster_of[root] == -1) {
+            Cluster *c = &clusters->elems[clusters->len];
+            c->colors[0] = c->colors[1] = bb_empty();
+            c->sees[0] = c->sees[1] = bb_empty();
+            cluster_of[root] = clusters->len++;
+        }
+
+        Cluster *c = &clusters->elems[cluster_of[root]];
+        bb_add(&c->colors[parity[idx]], idx);
+        c->sees[parity[idx]] = bb_or(c->sees[parity[idx]],
+                                     grid->peer_masks[idx]);
+    }
+}
+
+// Returns idx's root, leaving parity[idx] set to whether idx has the other
+// color from it
+static int uf_find(int parent[81], unsigned char parity[81], int idx) {
+    if (parent[idx] == idx) return idx;
+
+    int root = uf_find(parent, parity, parent[idx]);
+    parity[idx] ^= parity[parent[idx]];
+    parent[idx] = root;
+    return root;
+}
+
+// Puts a and b in the same cluster with opposite colors
+static void uf_union(int parent[81], unsigned char parity[81], int a, int b) {
+    int root_a = uf_find(parent, parity, a);
+    int root_b = uf_find(parent, parity, b);
+    if (root_a == root_b) return;
+
+    parent[root_b] = root_a;
+    parity[root_b] = parity[a] ^ parity[b] ^ 1;
+}
+
+static void print_color(DynStr *ds, Bitboard color) {
+    int idxs[81];
+    int num_idxs = bb_to_idxs(color, idxs);
+    ds_append(ds, "(");
+    print_idxs(ds, idxs, num_idxs);
+    ds_append(ds, ")");
+}
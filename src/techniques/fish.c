@@ -0,0 +1,613 @@
+#include "techniques/fish.h"
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "bits.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+// Sets of units as scope masks, bit type * 9 + index for each unit
+#define ROW_UNITS 0x1ff
+#define COL_UNITS (0x1ff << 9)
+#define BOX_UNITS (0x1ffu << 18)
+
+// Cover search nodes a call gets, split evenly between its sizes and digits so
+// that what is found for a digit doesn't depend on which others are in scope.
+// Franken and mutant fish can't always be searched in full in the time a step
+// has, so once a digit's share runs out the rest of its search is left unfound
+#define MAX_FISH_NODES 100000
+
+typedef enum {
+    FISH_BASIC,
+    FISH_FRANKEN,
+    FISH_MUTANT
+} FishKind;
+
+typedef enum {
+    FINS_NONE,
+    FINS_SOME,
+    FINS_ANY
+} FinRule;
+
+// One search for fish of a kind, a size and a digit at a time. unit_cands
+// holds the digit's cells in each unit, and bases and covers the units picked
+// so far. needed_types are the types of unit the covers must include for the
+// bases picked, and nodes_left what remains of the digit's budget
+typedef struct {
+    Grid *grid;
+    Step *step;
+    StepSink *sink;
+    FishKind kind;
+    FinRule fin_rule;
+    int size;
+    int nodes_left;
+    Bitboard cands;
+    Bitboard unit_cands[27];
+    unsigned int cover_units;
+    unsigned int needed_types;
+    int bases[MAX_FISH_SIZE];
+    unsigned int base_mask;
+    Bitboard base_cells;
+    int covers[MAX_FISH_SIZE];
+} FishSearch;
+
+// Where a cover search stands. Each base cell is covered, a fin or still open.
+// removable is what the fins so far leave to remove, and finnable the base
+// cells that could still be fins, which are those seeing a removable cell once
+// there is a fin. excluded holds the units that can't be picked any more and
+// cover_types the types of those that were
+typedef struct {
+    int depth;
+    unsigned int cover_types;
+    Bitboard covered;
+    Bitboard fins;
+    Bitboard removable;
+    Bitboard finnable;
+    unsigned int excluded;
+} CoverState;
+
+static bool fish_search(Grid *grid, Step *step, StepSink *sink,
+                        FishKind kind, FinRule fin_rule, int min_size,
+                        int max_size);
+static bool search_digit(FishSearch *search, int value);
+static bool fish_shape(FishSearch *search, int value,
+                       unsigned int base_units, unsigned int cover_units);
+static bool search_bases(FishSearch *search, unsigned int base_units,
+                         int start, int depth);
+static bool search_covers(FishSearch *search, CoverState state);
+static bool add_fins(FishSearch *search, CoverState *state, Bitboard cells);
+static int count_needed_covers(FishSearch *search, CoverState *state,
+                               Bitboard cells);
+static bool emit_fish(FishSearch *search, CoverState state);
+static int needed_cover_types(FishKind kind, unsigned int base_types);
+static bool is_sashimi(FishStep *s);
+static void print_units(DynStr *ds, int units[], int num_units);
+
+bool x_wing(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_X_WING};
+    return fish_search(grid, &step, sink, FISH_BASIC, FINS_NONE, 2, 2);
+}
+
+bool swordfish(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_SWORDFISH};
+    return fish_search(grid, &step, sink, FISH_BASIC, FINS_NONE, 3, 3);
+}
+
+bool jellyfish(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_JELLYFISH};
+    return fish_search(grid, &step, sink, FISH_BASIC, FINS_NONE, 4, 4);
+}
+
+bool finned_x_wing(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_FINNED_X_WING};
+    return fish_search(grid, &step, sink, FISH_BASIC, FINS_SOME, 2, 2);
+}
+
+bool finned_swordfish(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_FINNED_SWORDFISH};
+    return fish_search(grid, &step, sink, FISH_BASIC, FINS_SOME, 3, 3);
+}
+
+bool finned_jellyfish(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_FINNED_JELLYFISH};
+    return fish_search(grid, &step, sink, FISH_BASIC, FINS_SOME, 4, 4);
+}
+
+// Franken and mutant fish come in every size, finned or not
+bool franken_fish(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_FRANKEN_FISH};
+    return fish_search(grid, &step, sink, FISH_FRANKEN, FINS_ANY, 2,
+                       MAX_FISH_SIZE);
+}
+
+bool mutant_fish(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_MUTANT_FISH};
+    return fish_search(grid, &step, sink, FISH_MUTANT, FINS_ANY, 2,
+                       MAX_FISH_SIZE);
+}
+
+void fish_apply(Grid *grid, Step *step) {
+    FishStep *s = &step->as.fish;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_remove_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void fish_revert(Grid *grid, Step *step) {
+    FishStep *s = &step->as.fish;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_add_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void fish_explain(DynStr *ds, Step *step) {
+    FishStep *s = &step->as.fish;
+
+    ds_append(ds, "[");
+    if (!bb_is_empty(s->fins)) {
+        ds_append(ds, is_sashimi(s) ? "Sashimi " : "Finned ");
+    }
+    if (step->tech == TECH_FRANKEN_FISH) {
+        ds_append(ds, "Franken ");
+    } else if (step->tech == TECH_MUTANT_FISH) {
+        ds_append(ds, "Mutant ");
+    }
+    ds_appendf(ds, "%s (", FISH_NAME_FROM_SIZE(s->size));
+    print_units(ds, s->base_units, s->size);
+    ds_append(ds, " -> ");
+    print_units(ds, s->cover_units, s->size);
+    ds_appendf(ds, ")] {%d}", s->value);
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->fins, idxs);
+    if (num_idxs > 0) {
+        ds_appendf(ds, " with fin%s on ", num_idxs > 1 ? "s" : "");
+        print_idxs(ds, idxs, num_idxs);
+    }
+    ds_append(ds, ":\n");
+
+    num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        int row = ROW_FROM_IDX(idxs[i]);
+        int col = COL_FROM_IDX(idxs[i]);
+
+        ds_appendf(ds, "- Removed {%d} from r%dc%d\n", s->value, row + 1,
+                   col + 1);
+    }
+}
+
+void fish_colorise(ColorPair colors[81][9], Step *step) {
+    FishStep *s = &step->as.fish;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->cells, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_TRIGGER;
+    }
+
+    num_idxs = bb_to_idxs(s->fins, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_SPECIAL;
+    }
+
+    num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_REMOVAL;
+    }
+}
+
+void fish_encode(Bytes *out, Step *step) {
+    FishStep *s = &step->as.fish;
+
+    encode_idxs(out, s->base_units, s->size);
+    encode_idxs(out, s->cover_units, s->size);
+    encode_uint(out, s->value);
+    encode_bitboard(out, s->cells);
+    encode_bitboard(out, s->fins);
+    encode_bitboard(out, s->removals);
+}
+
+void fish_decode(Decoder *in, Step *step) {
+    FishStep *s = &step->as.fish;
+
+    // Units are written like cell indices, but only go up to 26
+    s->size = decode_max(in, MAX_FISH_SIZE);
+    for (int i = 0; i < s->size; i++) {
+        s->base_units[i] = decode_max(in, 26);
+    }
+    if (decode_uint(in) != (unsigned int)s->size) {
+        in->failed = true;
+    }
+    for (int i = 0; i < s->size; i++) {
+        s->cover_units[i] = decode_max(in, 26);
+    }
+    s->value = decode_digit(in);
+    s->cells = decode_bitboard(in);
+    s->fins = decode_bitboard(in);
+    s->removals = decode_bitboard(in);
+}
+
+void fish_effects(StepEffects *out, Step *step) {
+    FishStep *s = &step->as.fish;
+
+    CandSet cands = cand_set_from_values(1, s->value);
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        step_effects_remove(out, idxs[i], cands);
+    }
+}
+
+// Tries every size, smallest first, on every digit
+static bool fish_search(Grid *grid, Step *step, StepSink *sink,
+                        FishKind kind, FinRule fin_rule, int min_size,
+                        int max_size) {
+    FishSearch search = {.grid = grid,
+                         .step = step,
+                         .sink = sink,
+                         .kind = kind,
+                         .fin_rule = fin_rule};
+    int digit_nodes = MAX_FISH_NODES / ((max_size - min_size + 1) * 9);
+
+    for (int size = min_size; size <= max_size; size++) {
+        search.size = size;
+        for (int value = 1; value <= 9; value++) {
+            if (!grid_digit_in_scope(grid, value)) continue;
+            search.nodes_left = digit_nodes;
+            if (!search_digit(&search, value)) return false;
+        }
+    }
+
+    return true;
+}
+
+// Basic fish take rows against columns, Franken fish add boxes to both sides
+// and mutant fish take any unit anywhere. Both orientations are searched
+static bool search_digit(FishSearch *search, int value) {
+    switch (search->kind) {
+    case FISH_BASIC:
+        return fish_shape(search, value, ROW_UNITS, COL_UNITS)
+               && fish_shape(search, value, COL_UNITS, ROW_UNITS);
+    case FISH_FRANKEN:
+        return fish_shape(search, value, ROW_UNITS | BOX_UNITS,
+                          COL_UNITS | BOX_UNITS)
+               && fish_shape(search, value, COL_UNITS | BOX_UNITS,
+                             ROW_UNITS | BOX_UNITS);
+    default:
+        return fish_shape(search, value, ALL_UNITS, ALL_UNITS);
+    }
+}
+
+static bool fish_shape(FishSearch *search, int value,
+                       unsigned int base_units, unsigned int cover_units) {
+    search->cands = grid_cells_with_cand(search->grid, value);
+    for (int unit = 0; unit < 27; unit++) {
+        search->unit_cands[unit] = bb_and(search->cands,
+                                          search->grid->unit_masks[unit]);
+    }
+    search->cover_units = cover_units;
+    search->base_mask = 0;
+    search->base_cells = bb_empty();
+    search->step->as.fish.value = value;
+
+    return search_bases(search, base_units, 0, 0);
+}
+
+// Base units can't share a candidate, or one placement would fill two of them
+static bool search_bases(FishSearch *search, unsigned int base_units,
+                         int start, int depth) {
+    if (depth == search->size) {
+        if (grid_is_cancelled(search->grid)) return false;
+        if (search->nodes_left <= 0) return true;
+
+        unsigned int base_types = 0;
+        for (int i = 0; i < search->size; i++) {
+            base_types |= BIT(search->bases[i] / 9);
+        }
+        int needed_types = needed_cover_types(search->kind, base_types);
+        if (needed_types == -1) return true;
+        search->needed_types = needed_types;
+
+        // Some cover has to reach past the bases for there to be anything to
+        // remove
+        unsigned int excluded = search->base_mask | ~search->cover_units;
+        Bitboard base = search->base_cells;
+        Bitboard extra = {0};
+        for (int unit = 0; unit < 27; unit++) {
+            if (IS_BIT_SET(excluded, unit)) continue;
+            Bitboard cells = search->unit_cands[unit];
+            if (((cells.lo & base.lo) | (cells.hi & base.hi)) == 0) continue;
+            extra.lo |= cells.lo & ~base.lo;
+            extra.hi |= cells.hi & ~base.hi;
+        }
+        if ((extra.lo | extra.hi) == 0) return true;
+
+        // Before the first fin any base cell could be one
+        CoverState state = {.depth = 0,
+                            .cover_types = 0,
+                            .covered = bb_empty(),
+                            .fins = bb_empty(),
+                            .removable = extra,
+                            .finnable = search->fin_rule == FINS_NONE
+                                            ? bb_empty()
+                                            : base,
+                            .excluded = excluded};
+        return search_covers(search, state);
+    }
+
+    for (int unit = start; unit < 27; unit++) {
+        if (!IS_BIT_SET(base_units, unit)) continue;
+
+        Bitboard cells = search->unit_cands[unit];
+        if (bb_is_empty(cells)) continue;
+        if (!bb_is_empty(bb_and(cells, search->base_cells))) continue;
+
+        Bitboard prev_cells = search->base_cells;
+        search->bases[depth] = unit;
+        search->base_mask |= BIT(unit);
+        search->base_cells = bb_or(prev_cells, cells);
+        bool should_continue = search_bases(search, base_units, unit + 1,
+                                            depth + 1);
+        search->base_mask &= ~BIT(unit);
+        search->base_cells = prev_cells;
+        if (!should_continue) return false;
+    }
+
+    return true;
+}
+
+// Covers an open base cell by each of its units in turn and then, if it could
+// be one, as a fin. A unit passed over is excluded from then on, so each set
+// of covers and fins is reached once. Cells with no unit left are fins straight
+// away. The cell picked is one that can't be a fin if there is one, with as
+// few units left as can be. A branch ends once nothing is left to remove, or
+// the cells that can't be fins need more covers than are left. It runs often
+// enough that bitboards are worked on by their halves rather than through
+// bitboard.c
+static bool search_covers(FishSearch *search, CoverState state) {
+    if (--search->nodes_left < 0) return true;
+
+    Bitboard base = search->base_cells;
+    Bitboard open = {.lo = base.lo & ~(state.covered.lo | state.fins.lo),
+                     .hi = base.hi & ~(state.covered.hi | state.fins.hi)};
+    if ((open.lo | open.hi) == 0) {
+        // Fewer covers than bases means the fins aren't optional, which a
+        // solvable grid can't have
+        if (state.depth < search->size) return true;
+        return emit_fish(search, state);
+    }
+    if (state.depth == search->size) {
+        if (!add_fins(search, &state, open)) return true;
+        return emit_fish(search, state);
+    }
+
+    bool has_fins = (state.fins.lo | state.fins.hi) != 0;
+    Bitboard reachable = state.covered;
+    Bitboard stranded = {0};
+    int idx = -1;
+    int best_units = 8;
+    Bitboard cells = open;
+    for (int cell = bb_pop(&cells); cell != -1; cell = bb_pop(&cells)) {
+        int units[3] = {ROW_FROM_IDX(cell), 9 + COL_FROM_IDX(cell),
+                        18 + BOX_FROM_IDX(cell)};
+        int num_units = 0;
+        for (int i = 0; i < 3; i++) {
+            if (IS_BIT_SET(state.excluded, units[i])) continue;
+            if (has_fins) {
+                reachable.lo |= search->unit_cands[units[i]].lo;
+                reachable.hi |= search->unit_cands[units[i]].hi;
+            }
+            num_units++;
+        }
+        if (num_units == 0) {
+            bb_add(&stranded, cell);
+            continue;
+        }
+        if (bb_has(state.finnable, cell)) {
+            num_units += 4;
+        }
+        if (num_units < best_units) {
+            idx = cell;
+            best_units = num_units;
+        }
+    }
+
+    if ((stranded.lo | stranded.hi) != 0
+        && !add_fins(search, &state, stranded)) {
+        return true;
+    }
+    if (has_fins && ((state.removable.lo & ~reachable.lo)
+                     | (state.removable.hi & ~reachable.hi)) != 0) {
+        state.removable.lo &= reachable.lo;
+        state.removable.hi &= reachable.hi;
+        if (!add_fins(search, &state, (Bitboard){0})) return true;
+    }
+    if (idx == -1) return search_covers(search, state);
+
+    open.lo &= ~(stranded.lo | state.finnable.lo);
+    open.hi &= ~(stranded.hi | state.finnable.hi);
+    if (count_needed_covers(search, &state, open)
+        > search->size - state.depth) {
+        return true;
+    }
+
+    // The covers left have to make up for the types the fish still needs
+    int covers_left = search->size - state.depth - 1;
+    int units[3] = {ROW_FROM_IDX(idx), 9 + COL_FROM_IDX(idx),
+                    18 + BOX_FROM_IDX(idx)};
+    for (int i = 0; i < 3; i++) {
+        if (IS_BIT_SET(state.excluded, units[i])) continue;
+        unsigned int types = SET_BIT(state.cover_types, units[i] / 9);
+        if (count_ones(search->needed_types & ~types) > covers_left) continue;
+
+        CoverState next = state;
+        next.depth++;
+        next.cover_types = types;
+        next.covered.lo |= search->unit_cands[units[i]].lo;
+        next.covered.hi |= search->unit_cands[units[i]].hi;
+        next.excluded |= BIT(units[i]);
+        search->covers[state.depth] = units[i];
+        if (!search_covers(search, next)) return false;
+
+        state.excluded |= BIT(units[i]);
+    }
+
+    if (!bb_has(state.finnable, idx)) return true;
+
+    Bitboard fin = {0};
+    bb_add(&fin, idx);
+    if (!add_fins(search, &state, fin)) return true;
+    return search_covers(search, state);
+}
+
+// Makes fins of cells, keeping the removable cells that see all of them, and
+// works out which base cells could still join them. Returns false when one
+// of cells can't be a fin or nothing is left to remove
+static bool add_fins(FishSearch *search, CoverState *state, Bitboard cells) {
+    if (((cells.lo & ~state->finnable.lo) | (cells.hi & ~state->finnable.hi))
+        != 0) {
+        return false;
+    }
+
+    Bitboard *peer_masks = search->grid->peer_masks;
+    Bitboard removable = state->removable;
+    for (int cell = bb_pop(&cells); cell != -1; cell = bb_pop(&cells)) {
+        bb_add(&state->fins, cell);
+        removable.lo &= peer_masks[cell].lo;
+        removable.hi &= peer_masks[cell].hi;
+    }
+    if ((removable.lo | removable.hi) == 0) return false;
+    state->removable = removable;
+
+    Bitboard finnable = {0};
+    for (int cell = bb_pop(&removable); cell != -1;
+         cell = bb_pop(&removable)) {
+        finnable.lo |= peer_masks[cell].lo;
+        finnable.hi |= peer_masks[cell].hi;
+    }
+    state->finnable.lo = finnable.lo & search->base_cells.lo;
+    state->finnable.hi = finnable.hi & search->base_cells.hi;
+    return true;
+}
+
+// How many covers cells need at least: picks cells no two of which share a
+// unit that can still be picked, as each of those needs a cover of its own
+static int count_needed_covers(FishSearch *search, CoverState *state,
+                               Bitboard cells) {
+    Bitboard *unit_masks = search->grid->unit_masks;
+    int count = 0;
+    for (int cell = bb_pop(&cells); cell != -1; cell = bb_pop(&cells)) {
+        int units[3] = {ROW_FROM_IDX(cell), 9 + COL_FROM_IDX(cell),
+                        18 + BOX_FROM_IDX(cell)};
+        for (int i = 0; i < 3; i++) {
+            if (IS_BIT_SET(state->excluded, units[i])) continue;
+            cells.lo &= ~unit_masks[units[i]].lo;
+            cells.hi &= ~unit_masks[units[i]].hi;
+        }
+        count++;
+    }
+    return count;
+}
+
+static bool emit_fish(FishSearch *search, CoverState state) {
+    FishStep *s = &search->step->as.fish;
+
+    bool has_fins = !bb_is_empty(state.fins);
+    if (search->fin_rule == FINS_SOME && !has_fins) return true;
+
+    Bitboard removals = bb_and_not(state.covered, search->base_cells);
+    if (has_fins) {
+        removals = bb_and(removals, state.removable);
+    }
+    if (bb_is_empty(removals)) return true;
+
+    // Covers were picked in the order their cells came up, so they're sorted
+    // for the explanation
+    for (int i = 0; i < search->size; i++) {
+        int cover = search->covers[i];
+        int j = i;
+        for (; j > 0 && s->cover_units[j - 1] > cover; j--) {
+            s->cover_units[j] = s->cover_units[j - 1];
+        }
+        s->cover_units[j] = cover;
+        s->base_units[i] = search->bases[i];
+    }
+    s->size = search->size;
+    s->cells = search->base_cells;
+    s->fins = state.fins;
+    s->removals = removals;
+
+    return step_sink_emit(search->sink, search->step);
+}
+
+// A basic fish is rows against columns. A Franken fish adds boxes, but still
+// keeps rows out of the covers of a fish with rows among its bases, and the
+// same for columns. A mutant fish breaks that both ways, which takes a box
+// among the bases unless they hold both rows and columns. The shapes searched
+// already keep each kind to its own units, so this is what the covers must add
+static int needed_cover_types(FishKind kind, unsigned int base_types) {
+    unsigned int lines = BIT(UNIT_ROW) | BIT(UNIT_COL);
+    unsigned int base_lines = base_types & lines;
+
+    switch (kind) {
+    case FISH_BASIC:
+        return 0;
+    case FISH_FRANKEN:
+        return IS_BIT_SET(base_types, UNIT_BOX) ? 0 : BIT(UNIT_BOX);
+    default:
+        if (base_lines == lines) return 0;
+        if (!IS_BIT_SET(base_types, UNIT_BOX)) return -1;
+        return base_lines != 0 ? base_lines : lines;
+    }
+}
+
+// A finned fish is sashimi when a base unit is left with at most one cell once
+// the fins are taken out
+static bool is_sashimi(FishStep *s) {
+    for (int i = 0; i < s->size; i++) {
+        int body = 0;
+        for (int j = 0; j < 9; j++) {
+            int idx = IDX_FROM_UNIT(s->base_units[i], j);
+            if (bb_has(s->cells, idx) && !bb_has(s->fins, idx)) body++;
+        }
+        if (body <= 1) return true;
+    }
+    return false;
+}
+
+// Units of one type share their name, as in "Rows 1, 5". Mixed ones are named
+// one by one
+static void print_units(DynStr *ds, int units[], int num_units) {
+    bool is_same_type = true;
+    for (int i = 1; i < num_units; i++) {
+        is_same_type = is_same_type && units[i] / 9 == units[0] / 9;
+    }
+
+    if (is_same_type) {
+        ds_appendf(ds, "%s ", UNIT_TO_STR_PLURAL(units[0] / 9));
+    }
+    for (int i = 0; i < num_units; i++) {
+        if (!is_same_type) {
+            ds_appendf(ds, "%s ", UNIT_TO_STR(units[i] / 9));
+        }
+        ds_appendf(ds, "%d", units[i] % 9 + 1);
+        if (i < num_units - 1) {
+            ds_append(ds, ", ");
+        }
+    }
+}
@@ -0,0 +1,451 @@
+#include "techniques/forcing_chain.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "bits.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "links.h"
+#include "propagate.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+#define NODE_SET_WORDS ((NUM_NODES + 63) / 64)
+
+typedef struct {
+    unsigned long long bits[NODE_SET_WORDS];
+} NodeSet;
+
+// The placements and removals that assuming a candidate forces, or whether it
+// ends in a conflict
+typedef struct {
+    NodeSet placed;
+    NodeSet removed;
+    bool is_conflict;
+    bool is_known;
+} Implications;
+
+// Each candidate is assumed at most once per search, however many cells and
+// units it takes part in, and its implications kept for the rest
+typedef struct {
+    Grid *grid;
+    Propagator prop;
+    Implications implications[NUM_NODES];
+} ForcingSearch;
+
+static bool find_nishio(ForcingSearch *search, StepSink *sink);
+static bool find_cell_forcing(ForcingSearch *search, StepSink *sink);
+static bool find_unit_forcing(ForcingSearch *search, StepSink *sink);
+static bool forcing_group(ForcingSearch *search, Step *step,
+                          int branches[], int num_branches, StepSink *sink);
+static bool emit_conclusion(ForcingSearch *search, Step *step,
+                            int branches[], int num_branches, int node,
+                            bool is_placement, StepSink *sink);
+static Implications *implications_of(ForcingSearch *search, int node);
+static void node_set_add(NodeSet *set, int node);
+static void print_node(DynStr *ds, int node);
+
+bool forcing_chain(Grid *grid, StepSink *sink) {
+    ForcingSearch *search = malloc(sizeof(*search));
+    search->grid = grid;
+    prop_init(&search->prop, grid);
+    for (int node = 0; node < NUM_NODES; node++) {
+        search->implications[node].is_known = false;
+    }
+
+    bool should_continue = find_nishio(search, sink)
+                           && find_cell_forcing(search, sink)
+                           && find_unit_forcing(search, sink);
+
+    free(search);
+    return should_continue;
+}
+
+void forcing_chain_apply(Grid *grid, Step *step) {
+    ForcingStep *s = &step->as.forcing;
+    cell_remove_cands(grid->cells[NODE_IDX(s->conclusion)], s->removed_cands);
+}
+
+void forcing_chain_revert(Grid *grid, Step *step) {
+    ForcingStep *s = &step->as.forcing;
+    cell_add_cands(grid->cells[NODE_IDX(s->conclusion)], s->removed_cands);
+}
+
+void forcing_chain_explain(DynStr *ds, Step *step) {
+    ForcingStep *s = &step->as.forcing;
+
+    switch (s->kind) {
+    case FORCING_NISHIO:
+        ds_append(ds, "[Forcing Chain (Nishio)] ");
+        print_node(ds, s->conclusion);
+        ds_append(ds, " leads to a conflict");
+        break;
+    case FORCING_CELL: {
+        int idx = NODE_IDX(s->nodes[0]);
+        ds_appendf(ds, "[Forcing Chain (Cell r%dc%d)] Every candidate of "
+                   "r%dc%d ", ROW_FROM_IDX(idx) + 1, COL_FROM_IDX(idx) + 1,
+                   ROW_FROM_IDX(idx) + 1, COL_FROM_IDX(idx) + 1);
+        break;
+    }
+    case FORCING_UNIT: {
+        char *unit_str = UNIT_TO_STR(s->unit / 9);
+        ds_appendf(ds, "[Forcing Chain (%s %d)] Every place of {%d} in %s %d ",
+                   unit_str, s->unit % 9 + 1, NODE_DIGIT(s->nodes[0]),
+                   unit_str, s->unit % 9 + 1);
+        break;
+    }
+    }
+    if (s->kind != FORCING_NISHIO) {
+        if (s->is_placement) {
+            ds_append(ds, "leads to ");
+            print_node(ds, s->conclusion);
+        } else {
+            int idx = NODE_IDX(s->conclusion);
+            ds_appendf(ds, "removes {%d} from r%dc%d",
+                       NODE_DIGIT(s->conclusion), ROW_FROM_IDX(idx) + 1,
+                       COL_FROM_IDX(idx) + 1);
+        }
+    }
+    ds_append(ds, ":\n");
+
+    int start = 0;
+    for (int b = 0; b < s->num_branches; b++) {
+        ds_append(ds, "- ");
+        for (int i = 0; i < s->branch_lens[b]; i++) {
+            if (i > 0) {
+                ds_append(ds, " -> ");
+            }
+            print_node(ds, s->nodes[start + i]);
+        }
+        start += s->branch_lens[b];
+
+        if (s->kind == FORCING_NISHIO) {
+            int row = ROW_FROM_IDX(s->conflict_idx);
+            int col = COL_FROM_IDX(s->conflict_idx);
+            if (s->conflict_unit != -1) {
+                ds_appendf(ds, ", leaving {%d} no place in %s %d",
+                           s->conflict_digit,
+                           UNIT_TO_STR(s->conflict_unit / 9),
+                           s->conflict_unit % 9 + 1);
+            } else if (s->conflict_digit != 0) {
+                ds_appendf(ds, ", forcing r%dc%d to %d after it lost it",
+                           row + 1, col + 1, s->conflict_digit);
+            } else {
+                ds_appendf(ds, ", leaving r%dc%d no candidates", row + 1,
+                           col + 1);
+            }
+        } else if (!s->is_placement) {
+            ds_append(ds, ", which sees it");
+        }
+        ds_append(ds, "\n");
+    }
+
+    int idx = NODE_IDX(s->conclusion);
+    ds_append(ds, "- Removed ");
+    print_cand_set(ds, s->removed_cands);
+    ds_appendf(ds, " from r%dc%d\n", ROW_FROM_IDX(idx) + 1,
+               COL_FROM_IDX(idx) + 1);
+}
+
+void forcing_chain_colorise(ColorPair colors[81][9], Step *step) {
+    ForcingStep *s = &step->as.forcing;
+
+    int start = 0;
+    for (int b = 0; b < s->num_branches; b++) {
+        for (int i = 0; i < s->branch_lens[b]; i++) {
+            int node = s->nodes[start + i];
+            colors[NODE_IDX(node)][NODE_DIGIT(node) - 1] = i == 0
+                                                               ? CP_SPECIAL
+                                                               : CP_TRIGGER;
+        }
+        start += s->branch_lens[b];
+    }
+
+    int idx = NODE_IDX(s->conclusion);
+    for (int cand = 1; cand <= 9; cand++) {
+        if (cand_set_has(s->removed_cands, cand)) {
+            colors[idx][cand - 1] = CP_REMOVAL;
+        }
+    }
+}
+
+// unit and the conflict's cell and unit can be -1, so they're stored plus one
+void forcing_chain_encode(Bytes *out, Step *step) {
+    ForcingStep *s = &step->as.forcing;
+
+    encode_uint(out, s->kind);
+    encode_uint(out, s->unit + 1);
+    encode_uint(out, s->num_branches);
+    int num_nodes = 0;
+    for (int b = 0; b < s->num_branches; b++) {
+        encode_uint(out, s->branch_lens[b]);
+        num_nodes += s->branch_lens[b];
+    }
+    for (int i = 0; i < num_nodes; i++) {
+        encode_uint(out, s->nodes[i]);
+    }
+    encode_uint(out, s->conclusion);
+    encode_uint(out, s->is_placement);
+    encode_cand_set(out, s->removed_cands);
+    if (s->kind == FORCING_NISHIO) {
+        encode_uint(out, s->conflict_idx + 1);
+        encode_uint(out, s->conflict_unit + 1);
+        encode_uint(out, s->conflict_digit);
+    }
+}
+
+void forcing_chain_decode(Decoder *in, Step *step) {
+    ForcingStep *s = &step->as.forcing;
+
+    s->kind = decode_max(in, FORCING_UNIT);
+    s->unit = (int)decode_max(in, 27) - 1;
+    s->num_branches = decode_max(in, MAX_FORCING_BRANCHES);
+    int num_nodes = 0;
+    for (int b = 0; b < s->num_branches; b++) {
+        s->branch_lens[b] = decode_max(in, MAX_FORCING_NODES - num_nodes);
+        num_nodes += s->branch_lens[b];
+    }
+    for (int i = 0; i < num_nodes; i++) {
+        s->nodes[i] = decode_node(in);
+    }
+    s->conclusion = decode_node(in);
+    s->is_placement = decode_max(in, 1);
+    s->removed_cands = decode_cand_set(in);
+    if (s->kind == FORCING_NISHIO) {
+        s->conflict_idx = (int)decode_max(in, 81) - 1;
+        s->conflict_unit = (int)decode_max(in, 27) - 1;
+        s->conflict_digit = decode_max(in, 9);
+    }
+}
+
+void forcing_chain_effects(StepEffects *out, Step *step) {
+    ForcingStep *s = &step->as.forcing;
+
+    if (s->is_placement) {
+        step_effects_place(out, NODE_IDX(s->conclusion),
+                           NODE_DIGIT(s->conclusion));
+    } else {
+        step_effects_remove(out, NODE_IDX(s->conclusion), s->removed_cands);
+    }
+}
+
+// A candidate whose assumption ends in a conflict can't be true
+static bool find_nishio(ForcingSearch *search, StepSink *sink) {
+    Step step = {.tech = TECH_FORCING_CHAIN};
+    ForcingStep *s = &step.as.forcing;
+    Propagator *prop = &search->prop;
+
+    for (int node = 0; node < NUM_NODES; node++) {
+        if (!prop_has_node(prop, node)) continue;
+        if (grid_is_cancelled(search->grid)) return false;
+        if (!implications_of(search, node)->is_conflict) continue;
+
+        int mark = prop_mark(prop);
+        prop_assume(prop, node);
+        PropConflict conflict = prop->conflict;
+        int len = prop_chain(prop, conflict.cause, s->nodes,
+                             MAX_FORCING_NODES);
+        prop_undo(prop, mark);
+        if (len == -1) continue;
+
+        s->kind = FORCING_NISHIO;
+        s->unit = -1;
+        s->branch_lens[0] = len;
+        s->num_branches = 1;
+        s->conclusion = node;
+        s->is_placement = false;
+        s->removed_cands = cand_set_from_values(1, NODE_DIGIT(node));
+        s->conflict_idx = conflict.idx;
+        s->conflict_unit = conflict.unit;
+        s->conflict_digit = conflict.digit;
+        if (!step_sink_emit(sink, &step)) return false;
+    }
+
+    return true;
+}
+
+static bool find_cell_forcing(ForcingSearch *search, StepSink *sink) {
+    Step step = {.tech = TECH_FORCING_CHAIN};
+    step.as.forcing.kind = FORCING_CELL;
+    step.as.forcing.unit = -1;
+
+    for (int idx = 0; idx < 81; idx++) {
+        Cell *cell = search->grid->cells[idx];
+        if (cell->cands.len < 2 || cell->cands.len > MAX_FORCING_BRANCHES) {
+            continue;
+        }
+        if (grid_is_cancelled(search->grid)) return false;
+
+        int cands[9];
+        int branches[MAX_FORCING_BRANCHES];
+        int num_branches = cand_set_to_arr(cell->cands, cands);
+        for (int i = 0; i < num_branches; i++) {
+            branches[i] = NODE(idx, cands[i]);
+        }
+        if (!forcing_group(search, &step, branches, num_branches, sink)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool find_unit_forcing(ForcingSearch *search, StepSink *sink) {
+    Step step = {.tech = TECH_FORCING_CHAIN};
+    step.as.forcing.kind = FORCING_UNIT;
+
+    for (int unit = 0; unit < 27; unit++) {
+        if (grid_is_cancelled(search->grid)) return false;
+        step.as.forcing.unit = unit;
+
+        for (int digit = 1; digit <= 9; digit++) {
+            int branches[MAX_FORCING_BRANCHES];
+            int num_branches = 0;
+
+            for (int i = 0; i < 9; i++) {
+                int node = NODE(IDX_FROM_UNIT(unit, i), digit);
+                if (!prop_has_node(&search->prop, node)) continue;
+                if (num_branches == MAX_FORCING_BRANCHES) {
+                    num_branches++;
+                    break;
+                }
+                branches[num_branches++] = node;
+            }
+
+            if (num_branches < 2 || num_branches > MAX_FORCING_BRANCHES) {
+                continue;
+            }
+            if (!forcing_group(search, &step, branches, num_branches,
+                               sink)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Emits every placement and removal that all the branches force. A branch
+// that ends in a conflict is left to nishio
+static bool forcing_group(ForcingSearch *search, Step *step,
+                          int branches[], int num_branches, StepSink *sink) {
+    NodeSet placed;
+    NodeSet removed;
+
+    for (int b = 0; b < num_branches; b++) {
+        Implications *imp = implications_of(search, branches[b]);
+        if (imp->is_conflict) return true;
+
+        for (int w = 0; w < NODE_SET_WORDS; w++) {
+            placed.bits[w] = b == 0 ? imp->placed.bits[w]
+                                    : placed.bits[w] & imp->placed.bits[w];
+            removed.bits[w] = b == 0 ? imp->removed.bits[w]
+                                     : removed.bits[w] & imp->removed.bits[w];
+        }
+    }
+
+    for (int w = 0; w < NODE_SET_WORDS; w++) {
+        for (int k = 0; k < 2; k++) {
+            unsigned long long bits = k == 0 ? placed.bits[w]
+                                             : removed.bits[w];
+            while (bits) {
+                int node = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if (!emit_conclusion(search, step, branches, num_branches,
+                                     node, k == 0, sink)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Each branch is followed again to get its chain, which is short next to
+// assuming every candidate. Conclusions whose chains don't fit are skipped
+static bool emit_conclusion(ForcingSearch *search, Step *step,
+                            int branches[], int num_branches, int node,
+                            bool is_placement, StepSink *sink) {
+    ForcingStep *s = &step->as.forcing;
+    Propagator *prop = &search->prop;
+    Cell *cell = search->grid->cells[NODE_IDX(node)];
+
+    CandSet removed = cand_set_from_values(1, NODE_DIGIT(node));
+    if (is_placement) {
+        removed = cand_set_difference(cell->cands, removed);
+        if (removed.len == 0) return true;
+    }
+
+    int num_nodes = 0;
+    for (int b = 0; b < num_branches; b++) {
+        int mark = prop_mark(prop);
+        prop_assume(prop, branches[b]);
+        int end = is_placement ? node : prop->removal_causes[node];
+        int len = prop_chain(prop, end, s->nodes + num_nodes,
+                             MAX_FORCING_NODES - num_nodes);
+        prop_undo(prop, mark);
+        if (len == -1) return true;
+
+        s->branch_lens[b] = len;
+        num_nodes += len;
+    }
+
+    s->num_branches = num_branches;
+    s->conclusion = node;
+    s->is_placement = is_placement;
+    s->removed_cands = removed;
+    return step_sink_emit(sink, step);
+}
+
+static Implications *implications_of(ForcingSearch *search, int node) {
+    Implications *imp = &search->implications[node];
+    if (imp->is_known) return imp;
+
+    Propagator *prop = &search->prop;
+    int mark = prop_mark(prop);
+    imp->is_conflict = !prop_assume(prop, node);
+    imp->is_known = true;
+    imp->placed = (NodeSet){0};
+    imp->removed = (NodeSet){0};
+
+    if (!imp->is_conflict) {
+        for (int idx = 0; idx < 81; idx++) {
+            Cell *cell = search->grid->cells[idx];
+            if (!cell_is_empty(cell)) continue;
+
+            if (prop->values[idx] != 0) {
+                node_set_add(&imp->placed, NODE(idx, prop->values[idx]));
+            }
+            for (int d = 1; d <= 9; d++) {
+                if (!cell_has_cand(cell, d) || d == prop->values[idx]) {
+                    continue;
+                }
+                if (!IS_BIT_SET(prop->cands[idx], d - 1)) {
+                    node_set_add(&imp->removed, NODE(idx, d));
+                }
+            }
+        }
+    }
+
+    prop_undo(prop, mark);
+    return imp;
+}
+
+static void node_set_add(NodeSet *set, int node) {
+    set->bits[node / 64] |= 1ull << (node % 64);
+}
+
+static void print_node(DynStr *ds, int node) {
+    int row = ROW_FROM_IDX(NODE_IDX(node));
+    int col = COL_FROM_IDX(NODE_IDX(node));
+
+    ds_appendf(ds, "r%dc%d=%d", row + 1, col + 1, NODE_DIGIT(node));
+}
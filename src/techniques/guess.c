@@ -0,0 +1,184 @@
+#include "techniques/guess.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "bits.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "links.h"
+#include "propagate.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+int guess_max_depth = GUESS_MAX_DEPTH_DEFAULT;
+
+static int sort_by_cands(Grid *grid, int idxs[81]);
+static bool refutes(Propagator *prop, int node, int depth);
+static int most_constrained(Propagator *prop);
+
+// The last resort, for when no technique applies. A candidate goes if placing
+// it ends in a conflict, or leaves a cell whose every candidate does within
+// one guess less. That cell is the one with the fewest candidates, usually
+// bivalue, so each guess only doubles the work. Depths are tried from 1 up,
+// but since no other cell is branched on, the depth of a step is only an
+// upper bound on the guesses the candidate needs
+bool guess(Grid *grid, StepSink *sink) {
+    if (guess_max_depth <= 0) return true;
+
+    Step step = {.tech = TECH_GUESS};
+    GuessStep *s = &step.as.guess;
+    Propagator *prop = malloc(sizeof(*prop));
+    prop_init(prop, grid);
+
+    int idxs[81];
+    int num_idxs = sort_by_cands(grid, idxs);
+
+    bool should_continue = true;
+    bool found = false;
+    for (int depth = 1; depth <= guess_max_depth && !found; depth++) {
+        for (int i = 0; i < num_idxs && should_continue; i++) {
+            if (grid_is_cancelled(grid)) {
+                should_continue = false;
+                break;
+            }
+
+            Cell *cell = grid->cells[idxs[i]];
+            CandSet removed = cand_set_empty();
+            for (int digit = 1; digit <= 9; digit++) {
+                if (cell_has_cand(cell, digit)
+                    && refutes(prop, NODE(idxs[i], digit), depth)) {
+                    cand_set_add(&removed, digit);
+                }
+            }
+            // Every candidate failing means the grid is already broken
+            if (removed.len == 0 || removed.len == cell->cands.len) continue;
+
+            s->idx = idxs[i];
+            s->removed_cands = removed;
+            s->depth = depth;
+            found = true;
+            should_continue = step_sink_emit(sink, &step);
+        }
+        if (!should_continue) break;
+    }
+
+    free(prop);
+    return should_continue;
+}
+
+void guess_apply(Grid *grid, Step *step) {
+    GuessStep *s = &step->as.guess;
+
+    cell_remove_cands(grid->cells[s->idx], s->removed_cands);
+}
+
+void guess_revert(Grid *grid, Step *step) {
+    GuessStep *s = &step->as.guess;
+
+    cell_add_cands(grid->cells[s->idx], s->removed_cands);
+}
+
+void guess_explain(DynStr *ds, Step *step) {
+    GuessStep *s = &step->as.guess;
+    int row = ROW_FROM_IDX(s->idx);
+    int col = COL_FROM_IDX(s->idx);
+
+    ds_append(ds, "[Guess] Guessing ");
+    print_cand_set(ds, s->removed_cands);
+    ds_appendf(ds, " in r%dc%d ends in a conflict within %d guess%s:\n",
+               row + 1, col + 1, s->depth, s->depth == 1 ? "" : "es");
+    ds_append(ds, "- Removed ");
+    print_cand_set(ds, s->removed_cands);
+    ds_appendf(ds, " from r%dc%d\n", row + 1, col + 1);
+}
+
+void guess_colorise(ColorPair colors[81][9], Step *step) {
+    GuessStep *s = &step->as.guess;
+
+    for (int cand = 1; cand <= 9; cand++) {
+        if (cand_set_has(s->removed_cands, cand)) {
+            colors[s->idx][cand - 1] = CP_REMOVAL;
+        }
+    }
+}
+
+void guess_encode(Bytes *out, Step *step) {
+    GuessStep *s = &step->as.guess;
+
+    encode_uint(out, s->idx);
+    encode_cand_set(out, s->removed_cands);
+    encode_uint(out, s->depth);
+}
+
+void guess_decode(Decoder *in, Step *step) {
+    GuessStep *s = &step->as.guess;
+
+    s->idx = decode_idx(in);
+    s->removed_cands = decode_cand_set(in);
+    s->depth = decode_uint(in);
+}
+
+void guess_effects(StepEffects *out, Step *step) {
+    GuessStep *s = &step->as.guess;
+
+    step_effects_remove(out, s->idx, s->removed_cands);
+}
+
+// Stores the empty cells in idxs, fewest candidates first. Returns how many
+// there are
+static int sort_by_cands(Grid *grid, int idxs[81]) {
+    int num_idxs = 0;
+    for (int len = 1; len <= 9; len++) {
+        for (int idx = 0; idx < 81; idx++) {
+            Cell *cell = grid->cells[idx];
+            if (cell->value == 0 && cell->cands.len == len) {
+                idxs[num_idxs++] = idx;
+            }
+        }
+    }
+    return num_idxs;
+}
+
+// Whether node can't be placed when depth guesses, itself included, are
+// allowed and each later guess is on the most constrained cell. prop is left
+// as it was
+static bool refutes(Propagator *prop, int node, int depth) {
+    int mark = prop_mark(prop);
+    bool is_refuted = !prop_assume(prop, node);
+
+    if (!is_refuted && depth > 1) {
+        int idx = most_constrained(prop);
+        is_refuted = idx != -1;
+        for (int digit = 1; digit <= 9 && is_refuted; digit++) {
+            if (IS_BIT_SET(prop->cands[idx], digit - 1)) {
+                is_refuted = refutes(prop, NODE(idx, digit), depth - 1);
+            }
+        }
+    }
+
+    prop_undo(prop, mark);
+    return is_refuted;
+}
+
+// The empty cell with the fewest candidates, or -1 if the grid is solved
+static int most_constrained(Propagator *prop) {
+    int best = -1;
+    int best_len = 10;
+    for (int idx = 0; idx < 81 && best_len > 2; idx++) {
+        if (prop->values[idx] != 0) continue;
+
+        int len = count_ones(prop->cands[idx]);
+        if (len < best_len) {
+            best = idx;
+            best_len = len;
+        }
+    }
+    return best;
+}
@@ -4,65 +4,63 @@
 
 #include "cand_set.h"
 #include "cell.h"
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 #include "techniques/combinations.h"
 #include "techniques/explain.h"
 
-static bool hidden_n_set_unit(Cell *units[9][9], Step *step, int size,
-                              UnitType unit_type);
+static bool hidden_n_set_unit(Grid *grid, Cell *units[9][9], Step *step,
+                              StepSink *sink, int size, UnitType unit_type);
 
-bool hidden_set(Grid *grid, Step *step) {
-    if (hidden_pair(grid, step)) return true;
-    if (hidden_triple(grid, step)) return true;
-    if (hidden_quad(grid, step)) return true;
-    return false;
+bool hidden_set(Grid *grid, StepSink *sink) {
+    return hidden_pair(grid, sink) && hidden_triple(grid, sink)
+           && hidden_quad(grid, sink);
 }
 
-bool hidden_pair(Grid *grid, Step *step) {
-    step->tech = TECH_HIDDEN_PAIR;
-    step->as.hidden_set.size = 2;
+bool hidden_pair(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_HIDDEN_PAIR};
+    step.as.hidden_set.size = 2;
 
-    if (hidden_n_set_unit(grid->rows, step, 2, UNIT_ROW)) return true;
-    if (hidden_n_set_unit(grid->cols, step, 2, UNIT_COL)) return true;
-    if (hidden_n_set_unit(grid->boxes, step, 2, UNIT_BOX)) return true;
-    return false;
+    return hidden_n_set_unit(grid, grid->rows, &step, sink, 2, UNIT_ROW)
+           && hidden_n_set_unit(grid, grid->cols, &step, sink, 2, UNIT_COL)
+           && hidden_n_set_unit(grid, grid->boxes, &step, sink, 2, UNIT_BOX);
 }
 
-bool hidden_triple(Grid *grid, Step *step) {
-    step->tech = TECH_HIDDEN_TRIPLE;
-    step->as.hidden_set.size = 3;
+bool hidden_triple(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_HIDDEN_TRIPLE};
+    step.as.hidden_set.size = 3;
 
-    if (hidden_n_set_unit(grid->rows, step, 3, UNIT_ROW)) return true;
-    if (hidden_n_set_unit(grid->cols, step, 3, UNIT_COL)) return true;
-    if (hidden_n_set_unit(grid->boxes, step, 3, UNIT_BOX)) return true;
-    return false;
+    return hidden_n_set_unit(grid, grid->rows, &step, sink, 3, UNIT_ROW)
+           && hidden_n_set_unit(grid, grid->cols, &step, sink, 3, UNIT_COL)
+           && hidden_n_set_unit(grid, grid->boxes, &step, sink, 3, UNIT_BOX);
 }
 
-bool hidden_quad(Grid *grid, Step *step) {
-    step->tech = TECH_HIDDEN_QUAD;
-    step->as.hidden_set.size = 4;
+bool hidden_quad(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_HIDDEN_QUAD};
+    step.as.hidden_set.size = 4;
 
-    if (hidden_n_set_unit(grid->rows, step, 4, UNIT_ROW)) return true;
-    if (hidden_n_set_unit(grid->cols, step, 4, UNIT_COL)) return true;
-    if (hidden_n_set_unit(grid->boxes, step, 4, UNIT_BOX)) return true;
-    return false;
+    return hidden_n_set_unit(grid, grid->rows, &step, sink, 4, UNIT_ROW)
+           && hidden_n_set_unit(grid, grid->cols, &step, sink, 4, UNIT_COL)
+           && hidden_n_set_unit(grid, grid->boxes, &step, sink, 4, UNIT_BOX);
 }
 
 void hidden_set_apply(Grid *grid, Step *step) {
     HiddenSetStep *s = &step->as.hidden_set;
 
-    for (int i = 0; i < s->size; i++) {
-        grid->cells[s->idxs[i]]->cands = s->cands;
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_remove_cands(grid->cells[s->removal_idxs[i]], s->removed_cands[i]);
     }
 }
 
 void hidden_set_revert(Grid *grid, Step *step) {
     HiddenSetStep *s = &step->as.hidden_set;
 
-    for (int i = 0; i < s->size; i++) {
+    for (int i = 0; i < s->num_removals; i++) {
         cell_add_cands(grid->cells[s->removal_idxs[i]], s->removed_cands[i]);
     }
 }
@@ -100,12 +98,46 @@ void hidden_set_colorise(ColorPair colors[81][9], Step *step) {
     }
 }
 
-static bool hidden_n_set_unit(Cell *units[9][9], Step *step, int size,
-                              UnitType unit_type) {
+void hidden_set_encode(Bytes *out, Step *step) {
+    HiddenSetStep *s = &step->as.hidden_set;
+
+    encode_idxs(out, s->idxs, s->size);
+    encode_cand_set(out, s->cands);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+    for (int i = 0; i < s->num_removals; i++) {
+        encode_cand_set(out, s->removed_cands[i]);
+    }
+    encode_unit(out, s->unit_type, s->unit_idx);
+}
+
+void hidden_set_decode(Decoder *in, Step *step) {
+    HiddenSetStep *s = &step->as.hidden_set;
+
+    s->size = decode_idxs(in, s->idxs, MAX_HIDDEN_SET_SIZE);
+    s->cands = decode_cand_set(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_HIDDEN_SET_REMOVALS);
+    for (int i = 0; i < s->num_removals; i++) {
+        s->removed_cands[i] = decode_cand_set(in);
+    }
+    decode_unit(in, &s->unit_type, &s->unit_idx);
+}
+
+void hidden_set_effects(StepEffects *out, Step *step) {
+    HiddenSetStep *s = &step->as.hidden_set;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        step_effects_remove(out, s->removal_idxs[i], s->removed_cands[i]);
+    }
+}
+
+static bool hidden_n_set_unit(Grid *grid, Cell *units[9][9], Step *step,
+                              StepSink *sink, int size, UnitType unit_type) {
     HiddenSetStep *s = &step->as.hidden_set;
     s->unit_type = unit_type;
 
     for (int unit_i = 0; unit_i < 9; unit_i++) {
+        if (!grid_unit_in_scope(grid, unit_type, unit_i)) continue;
         Cell **unit = units[unit_i];
 
         int missing_values[9];
@@ -119,6 +151,11 @@ static bool hidden_n_set_unit(Cell *units[9][9], Step *step, int size,
                                             size, sizeof(int), &num_combs);
 
         for (int comb_i = 0; comb_i < num_combs; comb_i++) {
+            if (grid_is_cancelled(grid)) {
+                free_combinations(combs);
+                return false;
+            }
+
             CandSet comb_set = cand_set_from_arr(combs[comb_i], size);
 
             Cell *possible_cells[9];
@@ -141,13 +178,14 @@ static bool hidden_n_set_unit(Cell *units[9][9], Step *step, int size,
             s->num_removals = num_removals;
             s->unit_idx = unit_i;
 
-            free_combinations(combs);
-
-            return true;
+            if (!step_sink_emit(sink, step)) {
+                free_combinations(combs);
+                return false;
+            }
         }
 
         free_combinations(combs);
     }
 
-    return false;
+    return true;
 }
@@ -3,22 +3,24 @@
 #include <stdbool.h>
 
 #include "cell.h"
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 #include "techniques/explain.h"
 
 static bool hidden_single_unit(Grid *grid, Cell *units[9][9], Step *step,
-                               UnitType unit_type);
+                               StepSink *sink, UnitType unit_type);
 
-bool hidden_single(Grid *grid, Step *step) {
-    step->tech = TECH_HIDDEN_SINGLE;
+bool hidden_single(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_HIDDEN_SINGLE};
 
-    if (hidden_single_unit(grid, grid->rows, step, UNIT_ROW)) return true;
-    if (hidden_single_unit(grid, grid->cols, step, UNIT_COL)) return true;
-    if (hidden_single_unit(grid, grid->boxes, step, UNIT_BOX)) return true;
-    return false;
+    return hidden_single_unit(grid, grid->rows, &step, sink, UNIT_ROW)
+           && hidden_single_unit(grid, grid->cols, &step, sink, UNIT_COL)
+           && hidden_single_unit(grid, grid->boxes, &step, sink, UNIT_BOX);
 }
 
 void hidden_single_apply(Grid *grid, Step *step) {
@@ -62,12 +64,40 @@ void hidden_single_colorise(ColorPair colors[81][9], Step *step) {
     }
 }
 
+void hidden_single_encode(Bytes *out, Step *step) {
+    HiddenSingleStep *s = &step->as.hidden_single;
+
+    encode_uint(out, s->idx);
+    encode_uint(out, s->value);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+    encode_cand_set(out, s->old_cands);
+    encode_unit(out, s->unit_type, s->unit_idx);
+}
+
+void hidden_single_decode(Decoder *in, Step *step) {
+    HiddenSingleStep *s = &step->as.hidden_single;
+
+    s->idx = decode_idx(in);
+    s->value = decode_digit(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_HIDDEN_SINGLE_REMOVALS);
+    s->old_cands = decode_cand_set(in);
+    decode_unit(in, &s->unit_type, &s->unit_idx);
+}
+
+void hidden_single_effects(StepEffects *out, Step *step) {
+    HiddenSingleStep *s = &step->as.hidden_single;
+
+    step_effects_place(out, s->idx, s->value);
+}
+
 static bool hidden_single_unit(Grid *grid, Cell *units[9][9], Step *step,
-                               UnitType unit_type) {
+                               StepSink *sink, UnitType unit_type) {
     HiddenSingleStep *s = &step->as.hidden_single;
     s->unit_type = unit_type;
 
     for (int unit_i = 0; unit_i < 9; unit_i++) {
+        if (!grid_unit_in_scope(grid, unit_type, unit_i)) continue;
         Cell **unit = units[unit_i];
 
         int missing_values[9];
@@ -97,9 +127,9 @@ static bool hidden_single_unit(Grid *grid, Cell *units[9][9], Step *step,
             s->old_cands = possible_cells[0]->cands;
             s->unit_idx = unit_i;
 
-            return true;
+            if (!step_sink_emit(sink, step)) return false;
         }
     }
 
-    return false;
+    return true;
 }
@@ -4,51 +4,49 @@
 
 #include "cand_set.h"
 #include "cell.h"
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 #include "techniques/combinations.h"
 #include "techniques/explain.h"
 
 static bool naked_n_set_unit(Grid *grid, Cell *units[9][9], Step *step,
-                             int size, UnitType unit_type);
+                             StepSink *sink, int size, UnitType unit_type);
 
-bool naked_set(Grid *grid, Step *step) {
-    if (naked_pair(grid, step)) return true;
-    if (naked_triple(grid, step)) return true;
-    if (naked_quad(grid, step)) return true;
-    return false;
+bool naked_set(Grid *grid, StepSink *sink) {
+    return naked_pair(grid, sink) && naked_triple(grid, sink)
+           && naked_quad(grid, sink);
 }
 
-bool naked_pair(Grid *grid, Step *step) {
-    step->tech = TECH_NAKED_PAIR;
-    step->as.naked_set.size = 2;
+bool naked_pair(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_NAKED_PAIR};
+    step.as.naked_set.size = 2;
 
-    if (naked_n_set_unit(grid, grid->rows, step, 2, UNIT_ROW)) return true;
-    if (naked_n_set_unit(grid, grid->cols, step, 2, UNIT_COL)) return true;
-    if (naked_n_set_unit(grid, grid->boxes, step, 2, UNIT_BOX)) return true;
-    return false;
+    return naked_n_set_unit(grid, grid->rows, &step, sink, 2, UNIT_ROW)
+           && naked_n_set_unit(grid, grid->cols, &step, sink, 2, UNIT_COL)
+           && naked_n_set_unit(grid, grid->boxes, &step, sink, 2, UNIT_BOX);
 }
 
-bool naked_triple(Grid *grid, Step *step) {
-    step->tech = TECH_NAKED_TRIPLE;
-    step->as.naked_set.size = 3;
+bool naked_triple(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_NAKED_TRIPLE};
+    step.as.naked_set.size = 3;
 
-    if (naked_n_set_unit(grid, grid->rows, step, 3, UNIT_ROW)) return true;
-    if (naked_n_set_unit(grid, grid->cols, step, 3, UNIT_COL)) return true;
-    if (naked_n_set_unit(grid, grid->boxes, step, 3, UNIT_BOX)) return true;
-    return false;
+    return naked_n_set_unit(grid, grid->rows, &step, sink, 3, UNIT_ROW)
+           && naked_n_set_unit(grid, grid->cols, &step, sink, 3, UNIT_COL)
+           && naked_n_set_unit(grid, grid->boxes, &step, sink, 3, UNIT_BOX);
 }
 
-bool naked_quad(Grid *grid, Step *step) {
-    step->tech = TECH_NAKED_QUAD;
-    step->as.naked_set.size = 4;
+bool naked_quad(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_NAKED_QUAD};
+    step.as.naked_set.size = 4;
 
-    if (naked_n_set_unit(grid, grid->rows, step, 4, UNIT_ROW)) return true;
-    if (naked_n_set_unit(grid, grid->cols, step, 4, UNIT_COL)) return true;
-    if (naked_n_set_unit(grid, grid->boxes, step, 4, UNIT_BOX)) return true;
-    return false;
+    return naked_n_set_unit(grid, grid->rows, &step, sink, 4, UNIT_ROW)
+           && naked_n_set_unit(grid, grid->cols, &step, sink, 4, UNIT_COL)
+           && naked_n_set_unit(grid, grid->boxes, &step, sink, 4, UNIT_BOX);
 }
 
 void naked_set_apply(Grid *grid, Step *step) {
@@ -92,10 +90,10 @@ void naked_set_explain(DynStr *ds, Step *step) {
 void naked_set_colorise(ColorPair colors[81][9], Step *step) {
     NakedSetStep *s = &step->as.naked_set;
 
-    int cands[4];
-    cand_set_to_arr(s->cands, cands);
+    int cands[9];
+    int num_cands = cand_set_to_arr(s->cands, cands);
 
-    for (int i = 0; i < s->size; i++) {
+    for (int i = 0; i < num_cands; i++) {
         int cand = cands[i];
         for (int j = 0; j < s->size; j++) {
             int idx = s->idxs[j];
@@ -108,12 +106,46 @@ void naked_set_colorise(ColorPair colors[81][9], Step *step) {
     }
 }
 
+void naked_set_encode(Bytes *out, Step *step) {
+    NakedSetStep *s = &step->as.naked_set;
+
+    encode_idxs(out, s->idxs, s->size);
+    encode_cand_set(out, s->cands);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+    for (int i = 0; i < s->num_removals; i++) {
+        encode_cand_set(out, s->removed_cands[i]);
+    }
+    encode_unit(out, s->unit_type, s->unit_idx);
+}
+
+void naked_set_decode(Decoder *in, Step *step) {
+    NakedSetStep *s = &step->as.naked_set;
+
+    s->size = decode_idxs(in, s->idxs, MAX_NAKED_SET_SIZE);
+    s->cands = decode_cand_set(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_NAKED_SET_REMOVALS);
+    for (int i = 0; i < s->num_removals; i++) {
+        s->removed_cands[i] = decode_cand_set(in);
+    }
+    decode_unit(in, &s->unit_type, &s->unit_idx);
+}
+
+void naked_set_effects(StepEffects *out, Step *step) {
+    NakedSetStep *s = &step->as.naked_set;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        step_effects_remove(out, s->removal_idxs[i], s->removed_cands[i]);
+    }
+}
+
 static bool naked_n_set_unit(Grid *grid, Cell *units[9][9], Step *step,
-                             int size, UnitType unit_type) {
+                             StepSink *sink, int size, UnitType unit_type) {
     NakedSetStep *s = &step->as.naked_set;
     s->unit_type = unit_type;
 
     for (int unit_i = 0; unit_i < 9; unit_i++) {
+        if (!grid_unit_in_scope(grid, unit_type, unit_i)) continue;
         Cell **unit = units[unit_i];
 
         Cell *possible_cells[9];
@@ -128,6 +160,11 @@ static bool naked_n_set_unit(Grid *grid, Cell *units[9][9], Step *step,
                                               sizeof(Cell *), &num_combs);
 
         for (int comb_i = 0; comb_i < num_combs; comb_i++) {
+            if (grid_is_cancelled(grid)) {
+                free_combinations(combs);
+                return false;
+            }
+
             Cell **comb = combs[comb_i];
 
             CandSet comb_cands = cells_cand_union(comb, size);
@@ -150,13 +187,14 @@ static bool naked_n_set_unit(Grid *grid, Cell *units[9][9], Step *step,
             s->num_removals = num_removals;
             s->unit_idx = unit_i;
 
-            free_combinations(combs);
-
-            return true;
+            if (!step_sink_emit(sink, step)) {
+                free_combinations(combs);
+                return false;
+            }
         }
 
         free_combinations(combs);
     }
 
-    return false;
+    return true;
 }
@@ -4,13 +4,16 @@
 
 #include "cand_set.h"
 #include "cell.h"
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 
-bool naked_single(Grid *grid, Step *step) {
-    step->tech = TECH_NAKED_SINGLE;
+bool naked_single(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_NAKED_SINGLE};
 
     for (int i = 0; i < 81; i++) {
         Cell *cell = grid->cells[i];
@@ -23,16 +26,16 @@ bool naked_single(Grid *grid, Step *step) {
         int num_removals = cells_with_cand(grid->peers[i], NUM_PEERS, value,
                                            removal_cells);
 
-        step->as.naked_single.idx = i;
-        step->as.naked_single.value = value;
+        step.as.naked_single.idx = i;
+        step.as.naked_single.value = value;
         cells_idxs(removal_cells, num_removals,
-                   step->as.naked_single.removal_idxs);
-        step->as.naked_single.num_removals = num_removals;
+                   step.as.naked_single.removal_idxs);
+        step.as.naked_single.num_removals = num_removals;
 
-        return true;
+        if (!step_sink_emit(sink, &step)) return false;
     }
 
-    return false;
+    return true;
 }
 
 void naked_single_apply(Grid *grid, Step *step) {
@@ -72,3 +75,26 @@ void naked_single_colorise(ColorPair colors[81][9], Step *step) {
         colors[removal_idx][s->value - 1] = CP_REMOVAL;
     }
 }
+
+void naked_single_encode(Bytes *out, Step *step) {
+    NakedSingleStep *s = &step->as.naked_single;
+
+    encode_uint(out, s->idx);
+    encode_uint(out, s->value);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+}
+
+void naked_single_decode(Decoder *in, Step *step) {
+    NakedSingleStep *s = &step->as.naked_single;
+
+    s->idx = decode_idx(in);
+    s->value = decode_digit(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_NAKED_SINGLE_REMOVALS);
+}
+
+void naked_single_effects(StepEffects *out, Step *step) {
+    NakedSingleStep *s = &step->as.naked_single;
+
+    step_effects_place(out, s->idx, s->value);
+}
@@ -0,0 +1,127 @@
+#include "techniques/pattern_overlay.h"
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "templates.h"
+#include "ui.h"
+
+// A digit's solution is one of its templates, so a candidate that no surviving
+// template uses can't be the digit. This covers every elimination on a single
+// digit, fish and coloring included
+bool pattern_overlay(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_PATTERN_OVERLAY};
+    PatternOverlayStep *s = &step.as.pattern_overlay;
+    TemplateIndex *index = grid_templates(grid);
+
+    for (int digit = 1; digit <= 9; digit++) {
+        if (!grid_digit_in_scope(grid, digit)) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        // No template fits a grid that has lost a solution digit
+        int d = digit - 1;
+        if (index->num_survivors[d] == 0) continue;
+
+        Bitboard cands = bb_and_not(index->allowed[d], index->placed[d]);
+        Bitboard removals = bb_and_not(cands, index->possible[d]);
+        if (bb_is_empty(removals)) continue;
+
+        s->value = digit;
+        s->num_templates = index->num_survivors[d];
+        s->cells = bb_and(cands, index->possible[d]);
+        s->removals = removals;
+        if (!step_sink_emit(sink, &step)) return false;
+    }
+
+    return true;
+}
+
+void pattern_overlay_apply(Grid *grid, Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_remove_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void pattern_overlay_revert(Grid *grid, Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        cell_add_cand(grid->cells[idxs[i]], s->value);
+    }
+}
+
+void pattern_overlay_explain(DynStr *ds, Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    ds_appendf(ds, "[Pattern Overlay] {%d} fits %d template%s, none of them "
+                   "using:\n",
+               s->value, s->num_templates, s->num_templates == 1 ? "" : "s");
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        int row = ROW_FROM_IDX(idxs[i]);
+        int col = COL_FROM_IDX(idxs[i]);
+
+        ds_appendf(ds, "- Removed {%d} from r%dc%d\n", s->value, row + 1,
+                   col + 1);
+    }
+}
+
+void pattern_overlay_colorise(ColorPair colors[81][9], Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->cells, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_TRIGGER;
+    }
+
+    num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        colors[idxs[i]][s->value - 1] = CP_REMOVAL;
+    }
+}
+
+void pattern_overlay_encode(Bytes *out, Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    encode_uint(out, s->value);
+    encode_uint(out, s->num_templates);
+    encode_bitboard(out, s->cells);
+    encode_bitboard(out, s->removals);
+}
+
+void pattern_overlay_decode(Decoder *in, Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    s->value = decode_digit(in);
+    s->num_templates = decode_uint(in);
+    s->cells = decode_bitboard(in);
+    s->removals = decode_bitboard(in);
+}
+
+void pattern_overlay_effects(StepEffects *out, Step *step) {
+    PatternOverlayStep *s = &step->as.pattern_overlay;
+
+    CandSet cands = cand_set_from_values(1, s->value);
+    int idxs[81];
+    int num_idxs = bb_to_idxs(s->removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        step_effects_remove(out, idxs[i], cands);
+    }
+}
@@ -3,24 +3,26 @@
 #include <stdbool.h>
 
 #include "cell.h"
+#include "codec.h"
 #include "dynstr.h"
 #include "grid.h"
 #include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
 #include "ui.h"
 #include "techniques/explain.h"
 
 static bool pointing_set_unit(Grid *grid, Cell *units[9][9], Step *step,
-                              UnitType unit_type);
+                              StepSink *sink, UnitType unit_type);
 static void find_removal_unit(Cell *cells[], UnitType trigger_type,
                               UnitType *out_type, int *out_idx);
 
-bool pointing_set(Grid *grid, Step *step) {
-    step->tech = TECH_POINTING_SET;
+bool pointing_set(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_POINTING_SET};
 
-    if (pointing_set_unit(grid, grid->rows, step, UNIT_ROW)) return true;
-    if (pointing_set_unit(grid, grid->cols, step, UNIT_COL)) return true;
-    if (pointing_set_unit(grid, grid->boxes, step, UNIT_BOX)) return true;
-    return false;
+    return pointing_set_unit(grid, grid->rows, &step, sink, UNIT_ROW)
+           && pointing_set_unit(grid, grid->cols, &step, sink, UNIT_COL)
+           && pointing_set_unit(grid, grid->boxes, &step, sink, UNIT_BOX);
 }
 
 void pointing_set_apply(Grid *grid, Step *step) {
@@ -73,8 +75,38 @@ void pointing_set_colorise(ColorPair colors[81][9], Step *step) {
     }
 }
 
+void pointing_set_encode(Bytes *out, Step *step) {
+    PointingSetStep *s = &step->as.pointing_set;
+
+    encode_idxs(out, s->idxs, s->size);
+    encode_uint(out, s->value);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+    encode_unit(out, s->trigger_unit_type, s->trigger_unit_idx);
+    encode_unit(out, s->removal_unit_type, s->removal_unit_idx);
+}
+
+void pointing_set_decode(Decoder *in, Step *step) {
+    PointingSetStep *s = &step->as.pointing_set;
+
+    s->size = decode_idxs(in, s->idxs, MAX_POINTING_SET_SIZE);
+    s->value = decode_digit(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_POINTING_SET_REMOVALS);
+    decode_unit(in, &s->trigger_unit_type, &s->trigger_unit_idx);
+    decode_unit(in, &s->removal_unit_type, &s->removal_unit_idx);
+}
+
+void pointing_set_effects(StepEffects *out, Step *step) {
+    PointingSetStep *s = &step->as.pointing_set;
+
+    CandSet cands = cand_set_from_values(1, s->value);
+    for (int i = 0; i < s->num_removals; i++) {
+        step_effects_remove(out, s->removal_idxs[i], cands);
+    }
+}
+
 static bool pointing_set_unit(Grid *grid, Cell *units[9][9], Step *step,
-                              UnitType unit_type) {
+                              StepSink *sink, UnitType unit_type) {
     PointingSetStep *s = &step->as.pointing_set;
     s->trigger_unit_type = unit_type;
 
@@ -87,6 +119,7 @@ static bool pointing_set_unit(Grid *grid, Cell *units[9][9], Step *step,
 
         for (int value_i = 0; value_i < num_missing_values; value_i++) {
             int value = missing_values[value_i];
+            if (!grid_digit_in_scope(grid, value)) continue;
 
             Cell *possible_cells[9];
             int num_possible_cells = cells_with_cand(unit, 9, value,
@@ -113,11 +146,11 @@ static bool pointing_set_unit(Grid *grid, Cell *units[9][9], Step *step,
             find_removal_unit(possible_cells, unit_type, &s->removal_unit_type,
                               &s->removal_unit_idx);
 
-            return true;
+            if (!step_sink_emit(sink, step)) return false;
         }
     }
 
-    return false;
+    return true;
 }
 
 static void find_removal_unit(Cell *cells[], UnitType trigger_type,
@@ -1,14 +1,27 @@
 #include "techniques/registry.h"
 
+#include <string.h>
+#include <strings.h>
+
 #include "step.h"
+#include "step_sink.h"
 
-#include "techniques/basic_fish.h"
-#include "techniques/finned_fish.h"
+#include "techniques/aic.h"
+#include "techniques/als_xz.h"
+#include "techniques/bug.h"
+#include "techniques/coloring.h"
+#include "techniques/fish.h"
+#include "techniques/forcing_chain.h"
+#include "techniques/guess.h"
 #include "techniques/hidden_set.h"
 #include "techniques/hidden_single.h"
 #include "techniques/naked_set.h"
 #include "techniques/naked_single.h"
+#include "techniques/pattern_overlay.h"
 #include "techniques/pointing_set.h"
+#include "techniques/sue_de_coq.h"
+#include "techniques/unique_rectangle.h"
+#include "techniques/wing.h"
 
 #define TECHNIQUE_OPS(tech) \
     { \
@@ -16,13 +29,53 @@
         .revert = tech##_revert, \
         .explain = tech##_explain, \
         .colorise = tech##_colorise, \
+        .encode = tech##_encode, \
+        .decode = tech##_decode, \
+        .effects = tech##_effects, \
     }
 
-TechniqueFn techniques[] = {naked_single,  hidden_single,    naked_pair,
-                            hidden_pair,   naked_triple,     hidden_triple,
-                            naked_quad,    hidden_quad,      pointing_set,
-                            x_wing,        swordfish,        jellyfish,
-                            finned_x_wing, finned_swordfish, finned_jellyfish};
+// Tried in order, so the first one to find a step is the easiest available.
+// Pattern Overlay makes every elimination a single digit allows, so any fish
+// or single-digit chain after it could never find a step. It comes after them
+// all, just before Forcing Chain. Franken and Mutant Fish cost up to a few
+// milliseconds a call, so they only run once the cheaper chains and sets have
+// failed. Naked sets remove candidates from the box or line shared by the
+// set, so they also depend on the units crossing theirs
+Technique techniques[] = {
+    {naked_single, TECH_NAKED_SINGLE, DEPS_GRID},
+    {hidden_single, TECH_HIDDEN_SINGLE, DEPS_UNITS},
+    {naked_pair, TECH_NAKED_PAIR, DEPS_UNITS_AND_CROSSINGS},
+    {hidden_pair, TECH_HIDDEN_PAIR, DEPS_UNITS},
+    {naked_triple, TECH_NAKED_TRIPLE, DEPS_UNITS_AND_CROSSINGS},
+    {hidden_triple, TECH_HIDDEN_TRIPLE, DEPS_UNITS},
+    {naked_quad, TECH_NAKED_QUAD, DEPS_UNITS_AND_CROSSINGS},
+    {hidden_quad, TECH_HIDDEN_QUAD, DEPS_UNITS},
+    {pointing_set, TECH_POINTING_SET, DEPS_DIGITS},
+    {x_wing, TECH_X_WING, DEPS_DIGITS},
+    {swordfish, TECH_SWORDFISH, DEPS_DIGITS},
+    {jellyfish, TECH_JELLYFISH, DEPS_DIGITS},
+    {finned_x_wing, TECH_FINNED_X_WING, DEPS_DIGITS},
+    {finned_swordfish, TECH_FINNED_SWORDFISH, DEPS_DIGITS},
+    {finned_jellyfish, TECH_FINNED_JELLYFISH, DEPS_DIGITS},
+    {xy_wing, TECH_XY_WING, DEPS_GRID},
+    {xyz_wing, TECH_XYZ_WING, DEPS_GRID},
+    {w_wing, TECH_W_WING, DEPS_GRID},
+    {unique_rectangle_1, TECH_UNIQUE_RECTANGLE_1, DEPS_GRID},
+    {unique_rectangle_2, TECH_UNIQUE_RECTANGLE_2, DEPS_GRID},
+    {unique_rectangle_4, TECH_UNIQUE_RECTANGLE_4, DEPS_GRID},
+    {unique_rectangle_3, TECH_UNIQUE_RECTANGLE_3, DEPS_GRID},
+    {simple_coloring, TECH_SIMPLE_COLORING, DEPS_DIGITS},
+    {multi_coloring, TECH_MULTI_COLORING, DEPS_DIGITS},
+    {sue_de_coq, TECH_SUE_DE_COQ, DEPS_UNITS},
+    {bug_plus_1, TECH_BUG_PLUS_1, DEPS_GRID},
+    {aic, TECH_AIC, DEPS_GRID},
+    {als_xz, TECH_ALS_XZ, DEPS_GRID},
+    {franken_fish, TECH_FRANKEN_FISH, DEPS_DIGITS},
+    {mutant_fish, TECH_MUTANT_FISH, DEPS_DIGITS},
+    {pattern_overlay, TECH_PATTERN_OVERLAY, DEPS_DIGITS},
+    {forcing_chain, TECH_FORCING_CHAIN, DEPS_GRID},
+    {guess, TECH_GUESS, DEPS_GRID},
+};
 
 TechniqueOps technique_ops[] = {
     [TECH_NAKED_SINGLE] = TECHNIQUE_OPS(naked_single),
@@ -34,10 +87,90 @@ TechniqueOps technique_ops[] = {
     [TECH_HIDDEN_TRIPLE] = TECHNIQUE_OPS(hidden_set),
     [TECH_HIDDEN_QUAD] = TECHNIQUE_OPS(hidden_set),
     [TECH_POINTING_SET] = TECHNIQUE_OPS(pointing_set),
-    [TECH_X_WING] = TECHNIQUE_OPS(basic_fish),
-    [TECH_SWORDFISH] = TECHNIQUE_OPS(basic_fish),
-    [TECH_JELLYFISH] = TECHNIQUE_OPS(basic_fish),
-    [TECH_FINNED_X_WING] = TECHNIQUE_OPS(finned_fish),
-    [TECH_FINNED_SWORDFISH] = TECHNIQUE_OPS(finned_fish),
-    [TECH_FINNED_JELLYFISH] = TECHNIQUE_OPS(finned_fish),
+    [TECH_X_WING] = TECHNIQUE_OPS(fish),
+    [TECH_SWORDFISH] = TECHNIQUE_OPS(fish),
+    [TECH_JELLYFISH] = TECHNIQUE_OPS(fish),
+    [TECH_FINNED_X_WING] = TECHNIQUE_OPS(fish),
+    [TECH_FINNED_SWORDFISH] = TECHNIQUE_OPS(fish),
+    [TECH_FINNED_JELLYFISH] = TECHNIQUE_OPS(fish),
+    [TECH_XY_WING] = TECHNIQUE_OPS(wing),
+    [TECH_XYZ_WING] = TECHNIQUE_OPS(wing),
+    [TECH_W_WING] = TECHNIQUE_OPS(wing),
+    [TECH_SIMPLE_COLORING] = TECHNIQUE_OPS(coloring),
+    [TECH_MULTI_COLORING] = TECHNIQUE_OPS(coloring),
+    [TECH_AIC] = TECHNIQUE_OPS(aic),
+    [TECH_SUE_DE_COQ] = TECHNIQUE_OPS(sue_de_coq),
+    [TECH_ALS_XZ] = TECHNIQUE_OPS(als_xz),
+    [TECH_FORCING_CHAIN] = TECHNIQUE_OPS(forcing_chain),
+    [TECH_UNIQUE_RECTANGLE_1] = TECHNIQUE_OPS(unique_rectangle),
+    [TECH_UNIQUE_RECTANGLE_2] = TECHNIQUE_OPS(unique_rectangle),
+    [TECH_UNIQUE_RECTANGLE_3] = TECHNIQUE_OPS(unique_rectangle),
+    [TECH_UNIQUE_RECTANGLE_4] = TECHNIQUE_OPS(unique_rectangle),
+    [TECH_BUG_PLUS_1] = TECHNIQUE_OPS(bug),
+    [TECH_PATTERN_OVERLAY] = TECHNIQUE_OPS(pattern_overlay),
+    [TECH_FRANKEN_FISH] = TECHNIQUE_OPS(fish),
+    [TECH_MUTANT_FISH] = TECHNIQUE_OPS(fish),
+    [TECH_GUESS] = TECHNIQUE_OPS(guess),
 };
+
+char *technique_names[] = {
+    [TECH_NAKED_SINGLE] = "Naked Single",
+    [TECH_HIDDEN_SINGLE] = "Hidden Single",
+    [TECH_NAKED_PAIR] = "Naked Pair",
+    [TECH_NAKED_TRIPLE] = "Naked Triple",
+    [TECH_NAKED_QUAD] = "Naked Quad",
+    [TECH_HIDDEN_PAIR] = "Hidden Pair",
+    [TECH_HIDDEN_TRIPLE] = "Hidden Triple",
+    [TECH_HIDDEN_QUAD] = "Hidden Quad",
+    [TECH_POINTING_SET] = "Pointing Set",
+    [TECH_X_WING] = "X-Wing",
+    [TECH_SWORDFISH] = "Swordfish",
+    [TECH_JELLYFISH] = "Jellyfish",
+    [TECH_FINNED_X_WING] = "Finned X-Wing",
+    [TECH_FINNED_SWORDFISH] = "Finned Swordfish",
+    [TECH_FINNED_JELLYFISH] = "Finned Jellyfish",
+    [TECH_XY_WING] = "XY-Wing",
+    [TECH_XYZ_WING] = "XYZ-Wing",
+    [TECH_W_WING] = "W-Wing",
+    [TECH_SIMPLE_COLORING] = "Simple Coloring",
+    [TECH_MULTI_COLORING] = "Multi-Coloring",
+    [TECH_AIC] = "AIC",
+    [TECH_SUE_DE_COQ] = "Sue de Coq",
+    [TECH_ALS_XZ] = "ALS-XZ",
+    [TECH_FORCING_CHAIN] = "Forcing Chain",
+    [TECH_UNIQUE_RECTANGLE_1] = "Unique Rectangle Type 1",
+    [TECH_UNIQUE_RECTANGLE_2] = "Unique Rectangle Type 2",
+    [TECH_UNIQUE_RECTANGLE_3] = "Unique Rectangle Type 3",
+    [TECH_UNIQUE_RECTANGLE_4] = "Unique Rectangle Type 4",
+    [TECH_BUG_PLUS_1] = "BUG+1",
+    [TECH_PATTERN_OVERLAY] = "Pattern Overlay",
+    [TECH_FRANKEN_FISH] = "Franken Fish",
+    [TECH_MUTANT_FISH] = "Mutant Fish",
+    [TECH_GUESS] = "Guess",
+};
+
+// Stores the first step tech finds in out. Returns false if there is none
+bool technique_find(Technique *tech, Grid *grid, Step *out) {
+    StepSink sink = step_sink_first(out);
+    tech->find_all(grid, &sink);
+    return sink.num_steps > 0;
+}
+
+// Finds the first technique whose name starts with name, ignoring case.
+// Returns -1 if there is none
+int technique_from_name(char *name) {
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        if (strncasecmp(technique_names[i], name, strlen(name)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Finds the technique called name, ignoring case. Returns -1 if there is none
+int technique_from_full_name(char *name) {
+    for (int i = 0; i < NUM_TECHNIQUES; i++) {
+        if (strcasecmp(technique_names[i], name) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,257 @@
+#include "techniques/sue_de_coq.h"
+
+#include <stdbool.h>
+
+#include "als.h"
+#include "bitboard.h"
+#include "bits.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+// Where a box and a line cross, as positions in each of the two units
+typedef struct {
+    int line_unit;
+    int box_unit;
+    int line_cross;
+    int box_cross;
+} Crossing;
+
+static bool sue_de_coq_crossing(AlsIndex *index, Crossing *cross, Step *step,
+                                StepSink *sink);
+static void add_removals(AlsIndex *index, int unit, int rest,
+                         unsigned int digits, SueDeCoqStep *s);
+static void print_part(DynStr *ds, Bitboard cells, CandSet cands);
+
+bool sue_de_coq(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_SUE_DE_COQ};
+    AlsIndex *index = grid_als(grid);
+
+    for (int box = 0; box < 9; box++) {
+        if (grid_is_cancelled(grid)) return false;
+
+        for (int i = 0; i < 3; i++) {
+            int row = box / 3 * 3 + i;
+            int col = box % 3 * 3 + i;
+            Crossing crosses[2] = {
+                {.line_unit = row,
+                 .box_unit = 18 + box,
+                 .line_cross = 7 << (box % 3 * 3),
+                 .box_cross = 7 << (i * 3)},
+                {.line_unit = 9 + col,
+                 .box_unit = 18 + box,
+                 .line_cross = 7 << (box / 3 * 3),
+                 .box_cross = 0x49 << i},
+            };
+
+            for (int c = 0; c < 2; c++) {
+                bool in_scope =
+                    grid_unit_in_scope(grid, UNIT_BOX, box)
+                    || grid_unit_in_scope(grid, c == 0 ? UNIT_ROW : UNIT_COL,
+                                          c == 0 ? row : col);
+                if (!in_scope) continue;
+                if (!sue_de_coq_crossing(index, &crosses[c], &step, sink)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void sue_de_coq_apply(Grid *grid, Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_remove_cands(grid->cells[s->removal_idxs[i]],
+                          s->removed_cands[i]);
+    }
+}
+
+void sue_de_coq_revert(Grid *grid, Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_add_cands(grid->cells[s->removal_idxs[i]], s->removed_cands[i]);
+    }
+}
+
+void sue_de_coq_explain(DynStr *ds, Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    ds_append(ds, "[Sue de Coq] ");
+    print_part(ds, s->cells[0], s->cands[0]);
+    ds_append(ds, " with ");
+    print_part(ds, s->cells[1], s->cands[1]);
+    ds_append(ds, " and ");
+    print_part(ds, s->cells[2], s->cands[2]);
+    ds_append(ds, ":\n");
+    for (int i = 0; i < s->num_removals; i++) {
+        int row = ROW_FROM_IDX(s->removal_idxs[i]);
+        int col = COL_FROM_IDX(s->removal_idxs[i]);
+
+        ds_append(ds, "- Removed ");
+        print_cand_set(ds, s->removed_cands[i]);
+        ds_appendf(ds, " from r%dc%d\n", row + 1, col + 1);
+    }
+}
+
+void sue_de_coq_colorise(ColorPair colors[81][9], Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    for (int i = 0; i < 3; i++) {
+        int idxs[81];
+        int num_idxs = bb_to_idxs(s->cells[i], idxs);
+        for (int j = 0; j < num_idxs; j++) {
+            for (int cand = 1; cand <= 9; cand++) {
+                if (!cand_set_has(s->cands[i], cand)) continue;
+                colors[idxs[j]][cand - 1] = i == 0 ? CP_SPECIAL : CP_TRIGGER;
+            }
+        }
+    }
+    for (int i = 0; i < s->num_removals; i++) {
+        for (int cand = 1; cand <= 9; cand++) {
+            if (cand_set_has(s->removed_cands[i], cand)) {
+                colors[s->removal_idxs[i]][cand - 1] = CP_REMOVAL;
+            }
+        }
+    }
+}
+
+void sue_de_coq_encode(Bytes *out, Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    for (int i = 0; i < 3; i++) {
+        encode_bitboard(out, s->cells[i]);
+        encode_cand_set(out, s->cands[i]);
+    }
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+    for (int i = 0; i < s->num_removals; i++) {
+        encode_cand_set(out, s->removed_cands[i]);
+    }
+}
+
+void sue_de_coq_decode(Decoder *in, Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    for (int i = 0; i < 3; i++) {
+        s->cells[i] = decode_bitboard(in);
+        s->cands[i] = decode_cand_set(in);
+    }
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_SUE_DE_COQ_REMOVALS);
+    for (int i = 0; i < s->num_removals; i++) {
+        s->removed_cands[i] = decode_cand_set(in);
+    }
+}
+
+void sue_de_coq_effects(StepEffects *out, Step *step) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        step_effects_remove(out, s->removal_idxs[i], s->removed_cands[i]);
+    }
+}
+
+// Tries every two or three empty cells of the crossing whose candidates number
+// at least two more than the cells, against every pair of almost locked sets
+// from the rest of the line and the rest of the box
+static bool sue_de_coq_crossing(AlsIndex *index, Crossing *cross, Step *step,
+                                StepSink *sink) {
+    SueDeCoqStep *s = &step->as.sue_de_coq;
+    int line_rest = ALL_POSITIONS & ~cross->line_cross;
+    int box_rest = ALL_POSITIONS & ~cross->box_cross;
+
+    int line_sets[NUM_UNIT_SETS];
+    int box_sets[NUM_UNIT_SETS];
+    int num_line_sets = als_unit_sets(index, cross->line_unit, line_rest,
+                                      line_sets);
+    int num_box_sets = als_unit_sets(index, cross->box_unit, box_rest,
+                                     box_sets);
+    if (num_line_sets == 0 || num_box_sets == 0) return true;
+
+    int empty = 0;
+    for (int i = 0; i < 9; i++) {
+        int idx = IDX_FROM_UNIT(cross->line_unit, i);
+        if (IS_BIT_SET(cross->line_cross, i) && index->cands[idx] != 0) {
+            empty |= BIT(i);
+        }
+    }
+
+    for (int set = empty; set != 0; set = (set - 1) & empty) {
+        int size = __builtin_popcount(set);
+        if (size < 2) continue;
+
+        unsigned int cands = als_set_cands(index, cross->line_unit, set);
+        if (__builtin_popcount(cands) < size + 2) continue;
+
+        for (int i = 0; i < num_line_sets; i++) {
+            unsigned int line_cands = als_set_cands(index, cross->line_unit,
+                                                    line_sets[i]);
+            if ((line_cands & cands) == 0) continue;
+
+            for (int j = 0; j < num_box_sets; j++) {
+                unsigned int box_cands = als_set_cands(index, cross->box_unit,
+                                                       box_sets[j]);
+                if ((box_cands & cands) == 0) continue;
+                if ((box_cands & line_cands) != 0) continue;
+
+                int num_cells = size + __builtin_popcount(line_sets[i])
+                                + __builtin_popcount(box_sets[j]);
+                unsigned int all = cands | line_cands | box_cands;
+                if (__builtin_popcount(all) != num_cells) continue;
+
+                s->num_removals = 0;
+                add_removals(index, cross->line_unit,
+                             line_rest & ~line_sets[i],
+                             (cands | line_cands) & ~box_cands, s);
+                add_removals(index, cross->box_unit,
+                             box_rest & ~box_sets[j],
+                             (cands | box_cands) & ~line_cands, s);
+                if (s->num_removals == 0) continue;
+
+                s->cells[0] = als_set_cells(cross->line_unit, set);
+                s->cells[1] = als_set_cells(cross->line_unit, line_sets[i]);
+                s->cells[2] = als_set_cells(cross->box_unit, box_sets[j]);
+                s->cands[0] = cand_set_from_mask(cands);
+                s->cands[1] = cand_set_from_mask(line_cands);
+                s->cands[2] = cand_set_from_mask(box_cands);
+                if (!step_sink_emit(sink, step)) return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Adds the digits each cell at the positions in rest of unit would lose
+static void add_removals(AlsIndex *index, int unit, int rest,
+                         unsigned int digits, SueDeCoqStep *s) {
+    for (int i = 0; i < 9; i++) {
+        if (!IS_BIT_SET(rest, i)) continue;
+
+        int idx = IDX_FROM_UNIT(unit, i);
+        unsigned int removed = index->cands[idx] & digits;
+        if (removed == 0) continue;
+
+        s->removal_idxs[s->num_removals] = idx;
+        s->removed_cands[s->num_removals] = cand_set_from_mask(removed);
+        s->num_removals++;
+    }
+}
+
+static void print_part(DynStr *ds, Bitboard cells, CandSet cands) {
+    int idxs[81];
+    int num_idxs = bb_to_idxs(cells, idxs);
+    print_idxs(ds, idxs, num_idxs);
+    ds_append(ds, " ");
+    print_cand_set(ds, cands);
+}
@@ -0,0 +1,490 @@
+#include "techniques/unique_rectangle.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "bits.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+// Two rows and two columns that cover exactly two boxes. Corners are (r1, c1),
+// (r1, c2), (r2, c1), (r2, c2), so 0 and 3 are opposite
+#define NUM_RECTANGLES 486
+
+typedef struct {
+    int idxs[4];
+    Bitboard cells;
+} Rectangle;
+
+// A rectangle whose corners all hold pair, with the corners in bivalue set by
+// position. The roof is the two corners that hold more than the pair
+typedef struct {
+    Rectangle *rect;
+    unsigned int pair;
+    int bivalue;
+    int roof[2];
+    unsigned int extras;
+} RectMatch;
+
+typedef struct {
+    unsigned int cands[81];
+    Bitboard cells_with[9];
+    Bitboard *peer_masks;
+} RectangleIndex;
+
+typedef bool (*RectangleRule)(RectangleIndex *index, RectMatch *match,
+                              Step *step, StepSink *sink);
+
+static Rectangle rectangles[NUM_RECTANGLES];
+static Bitboard unit_cells[27];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void build_tables(void);
+static bool search_rectangles(Grid *grid, TechniqueType tech,
+                              int num_bivalue, RectangleRule rule,
+                              StepSink *sink);
+static bool find_roof(RectangleIndex *index, RectMatch *match);
+static int shared_units(int a, int b, int out[2]);
+static bool type_1(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink);
+static bool type_2(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink);
+static bool type_3(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink);
+static bool type_3_unit(RectangleIndex *index, RectMatch *match, int unit,
+                        Step *step, StepSink *sink);
+static bool type_4(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink);
+static void start_step(RectMatch *match, UniqueRectangleStep *s);
+static void add_removal(UniqueRectangleStep *s, int idx, unsigned int cands);
+static void rectangle_idxs(int corners[2], int out[4]);
+
+bool unique_rectangle_1(Grid *grid, StepSink *sink) {
+    return search_rectangles(grid, TECH_UNIQUE_RECTANGLE_1, 3, type_1, sink);
+}
+
+bool unique_rectangle_2(Grid *grid, StepSink *sink) {
+    return search_rectangles(grid, TECH_UNIQUE_RECTANGLE_2, 2, type_2, sink);
+}
+
+bool unique_rectangle_3(Grid *grid, StepSink *sink) {
+    return search_rectangles(grid, TECH_UNIQUE_RECTANGLE_3, 2, type_3, sink);
+}
+
+bool unique_rectangle_4(Grid *grid, StepSink *sink) {
+    return search_rectangles(grid, TECH_UNIQUE_RECTANGLE_4, 2, type_4, sink);
+}
+
+void unique_rectangle_apply(Grid *grid, Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_remove_cands(grid->cells[s->removal_idxs[i]],
+                          s->removed_cands[i]);
+    }
+}
+
+void unique_rectangle_revert(Grid *grid, Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_add_cands(grid->cells[s->removal_idxs[i]], s->removed_cands[i]);
+    }
+}
+
+void unique_rectangle_explain(DynStr *ds, Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    int idxs[81];
+    rectangle_idxs(s->corners, idxs);
+    ds_appendf(ds, "[Unique Rectangle Type %d] ",
+               step->tech - TECH_UNIQUE_RECTANGLE_1 + 1);
+    print_cand_set(ds, s->cands);
+    ds_append(ds, " in ");
+    print_idxs(ds, idxs, 4);
+
+    switch (step->tech) {
+    case TECH_UNIQUE_RECTANGLE_2:
+        ds_append(ds, " with extra ");
+        print_cand_set(ds, s->set_cands);
+        break;
+    case TECH_UNIQUE_RECTANGLE_3: {
+        int num_idxs = bb_to_idxs(s->set_cells, idxs);
+        ds_append(ds, " with naked set ");
+        print_cand_set(ds, s->set_cands);
+        ds_append(ds, " in ");
+        print_idxs(ds, idxs, num_idxs);
+        break;
+    }
+    case TECH_UNIQUE_RECTANGLE_4:
+        ds_append(ds, " with ");
+        print_cand_set(ds, s->set_cands);
+        ds_append(ds, " locked in the roof");
+        break;
+    default: break;
+    }
+    ds_append(ds, ":\n");
+
+    for (int i = 0; i < s->num_removals; i++) {
+        int row = ROW_FROM_IDX(s->removal_idxs[i]);
+        int col = COL_FROM_IDX(s->removal_idxs[i]);
+
+        ds_append(ds, "- Removed ");
+        print_cand_set(ds, s->removed_cands[i]);
+        ds_appendf(ds, " from r%dc%d\n", row + 1, col + 1);
+    }
+}
+
+void unique_rectangle_colorise(ColorPair colors[81][9], Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    int idxs[81];
+    rectangle_idxs(s->corners, idxs);
+    for (int i = 0; i < 4; i++) {
+        for (int cand = 1; cand <= 9; cand++) {
+            if (cand_set_has(s->cands, cand)) {
+                colors[idxs[i]][cand - 1] = CP_TRIGGER;
+            } else if (cand_set_has(s->set_cands, cand)) {
+                colors[idxs[i]][cand - 1] = CP_SPECIAL;
+            }
+        }
+    }
+
+    int num_idxs = bb_to_idxs(s->set_cells, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        for (int cand = 1; cand <= 9; cand++) {
+            if (cand_set_has(s->set_cands, cand)) {
+                colors[idxs[i]][cand - 1] = CP_SPECIAL;
+            }
+        }
+    }
+    for (int i = 0; i < s->num_removals; i++) {
+        for (int cand = 1; cand <= 9; cand++) {
+            if (cand_set_has(s->removed_cands[i], cand)) {
+                colors[s->removal_idxs[i]][cand - 1] = CP_REMOVAL;
+            }
+        }
+    }
+}
+
+void unique_rectangle_encode(Bytes *out, Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    encode_idxs(out, s->corners, 2);
+    encode_cand_set(out, s->cands);
+    encode_bitboard(out, s->set_cells);
+    encode_cand_set(out, s->set_cands);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+    for (int i = 0; i < s->num_removals; i++) {
+        encode_cand_set(out, s->removed_cands[i]);
+    }
+}
+
+void unique_rectangle_decode(Decoder *in, Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    if (decode_idxs(in, s->corners, 2) != 2) {
+        in->failed = true;
+    }
+    s->cands = decode_cand_set(in);
+    s->set_cells = decode_bitboard(in);
+    s->set_cands = decode_cand_set(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs, MAX_UR_REMOVALS);
+    for (int i = 0; i < s->num_removals; i++) {
+        s->removed_cands[i] = decode_cand_set(in);
+    }
+}
+
+void unique_rectangle_effects(StepEffects *out, Step *step) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        step_effects_remove(out, s->removal_idxs[i], s->removed_cands[i]);
+    }
+}
+
+static void build_tables(void) {
+    int num_rects = 0;
+    for (int r1 = 0; r1 < 9; r1++) {
+        for (int r2 = r1 + 1; r2 < 9; r2++) {
+            for (int c1 = 0; c1 < 9; c1++) {
+                for (int c2 = c1 + 1; c2 < 9; c2++) {
+                    // Two boxes means the rows share a band or the columns
+                    // share a stack, but not both
+                    bool same_band = r1 / 3 == r2 / 3;
+                    bool same_stack = c1 / 3 == c2 / 3;
+                    if (same_band == same_stack) continue;
+
+                    Rectangle *rect = &rectangles[num_rects++];
+                    rect->idxs[0] = IDX_FROM_ROW_COL(r1, c1);
+                    rect->idxs[1] = IDX_FROM_ROW_COL(r1, c2);
+                    rect->idxs[2] = IDX_FROM_ROW_COL(r2, c1);
+                    rect->idxs[3] = IDX_FROM_ROW_COL(r2, c2);
+                    rect->cells = bb_empty();
+                    for (int i = 0; i < 4; i++) {
+                        bb_add(&rect->cells, rect->idxs[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int unit = 0; unit < 27; unit++) {
+        unit_cells[unit] = bb_empty();
+        for (int i = 0; i < 9; i++) {
+            bb_add(&unit_cells[unit], IDX_FROM_UNIT(unit, i));
+        }
+    }
+}
+
+// Uniqueness deductions are only sound for a puzzle known to have one
+// solution, so they find nothing until it has been verified. Only rectangles
+// with at least num_bivalue bivalue corners reach the rule, which a mask test
+// against the bivalue cells decides before any candidate is looked at
+static bool search_rectangles(Grid *grid, TechniqueType tech,
+                              int num_bivalue, RectangleRule rule,
+                              StepSink *sink) {
+    if (!grid->has_solution) return true;
+    pthread_once(&tables_once, build_tables);
+
+    Step step = {.tech = tech};
+    RectangleIndex index = {.peer_masks = grid->peer_masks};
+    Bitboard bivalue = bb_empty();
+    for (int idx = 0; idx < 81; idx++) {
+        index.cands[idx] = grid->cells[idx]->cands.cands;
+        if (grid->cells[idx]->cands.len == 2) bb_add(&bivalue, idx);
+    }
+    for (int digit = 1; digit <= 9; digit++) {
+        index.cells_with[digit - 1] = grid_cells_with_cand(grid, digit);
+    }
+
+    for (int i = 0; i < NUM_RECTANGLES; i++) {
+        Rectangle *rect = &rectangles[i];
+        if (bb_count(bb_and(rect->cells, bivalue)) != num_bivalue) continue;
+
+        RectMatch match = {.rect = rect, .pair = ALL_DIGITS, .bivalue = 0};
+        for (int j = 0; j < 4; j++) {
+            match.pair &= index.cands[rect->idxs[j]];
+            if (bb_has(bivalue, rect->idxs[j])) match.bivalue |= BIT(j);
+        }
+        if (__builtin_popcount(match.pair) != 2) continue;
+
+        int x = find_first_set(match.pair);
+        int y = find_first_set(UNSET_BIT(match.pair, x - 1));
+        if (!grid_digit_in_scope(grid, x) && !grid_digit_in_scope(grid, y)) {
+            continue;
+        }
+        if (grid_is_cancelled(grid)) return false;
+
+        if (!rule(&index, &match, &step, sink)) return false;
+    }
+
+    return true;
+}
+
+// The two bivalue corners must be on one side, or the roof cells wouldn't
+// share a unit
+static bool find_roof(RectangleIndex *index, RectMatch *match) {
+    if (match->bivalue == 0x9 || match->bivalue == 0x6) return false;
+
+    int num_roof = 0;
+    for (int i = 0; i < 4; i++) {
+        if (IS_BIT_SET(match->bivalue, i)) continue;
+
+        match->roof[num_roof++] = match->rect->idxs[i];
+    }
+    match->extras = (index->cands[match->roof[0]]
+                     | index->cands[match->roof[1]])
+                    & ~match->pair;
+    return true;
+}
+
+static int shared_units(int a, int b, int out[2]) {
+    int num_units = 0;
+    if (ROW_FROM_IDX(a) == ROW_FROM_IDX(b)) {
+        out[num_units++] = ROW_FROM_IDX(a);
+    } else {
+        out[num_units++] = 9 + COL_FROM_IDX(a);
+    }
+    if (BOX_FROM_IDX(a) == BOX_FROM_IDX(b)) {
+        out[num_units++] = 18 + BOX_FROM_IDX(a);
+    }
+    return num_units;
+}
+
+// If the one corner with more than the pair lost its extras, the pair could
+// be swapped around the rectangle, so the pair goes from that corner
+static bool type_1(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    start_step(match, s);
+    for (int i = 0; i < 4; i++) {
+        if (IS_BIT_SET(match->bivalue, i)) continue;
+
+        int idx = match->rect->idxs[i];
+        add_removal(s, idx, index->cands[idx] & match->pair);
+    }
+
+    return step_sink_emit(sink, step);
+}
+
+// Both roof cells have the same single extra candidate, one of them must be
+// it, so it goes from every cell that sees both
+static bool type_2(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+    if (!find_roof(index, match)) return true;
+
+    unsigned int extras_a = index->cands[match->roof[0]] & ~match->pair;
+    unsigned int extras_b = index->cands[match->roof[1]] & ~match->pair;
+    if (extras_a != extras_b || __builtin_popcount(extras_a) != 1) {
+        return true;
+    }
+
+    int extra = find_first_set(extras_a);
+    Bitboard removals = bb_and(
+        index->cells_with[extra - 1],
+        bb_and(index->peer_masks[match->roof[0]],
+               index->peer_masks[match->roof[1]]));
+    if (bb_is_empty(removals)) return true;
+
+    start_step(match, s);
+    s->set_cands = cand_set_from_mask(extras_a);
+
+    int idxs[81];
+    int num_idxs = bb_to_idxs(removals, idxs);
+    for (int i = 0; i < num_idxs; i++) {
+        add_removal(s, idxs[i], extras_a);
+    }
+
+    return step_sink_emit(sink, step);
+}
+
+// The extras of the roof act as one cell, since one roof cell must hold one
+// of them. With other cells of a shared unit they can form a naked set
+static bool type_3(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink) {
+    if (!find_roof(index, match)) return true;
+
+    int units[2];
+    int num_units = shared_units(match->roof[0], match->roof[1], units);
+    for (int i = 0; i < num_units; i++) {
+        if (!type_3_unit(index, match, units[i], step, sink)) return false;
+    }
+
+    return true;
+}
+
+static bool type_3_unit(RectangleIndex *index, RectMatch *match, int unit,
+                        Step *step, StepSink *sink) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+
+    int others[9];
+    int num_others = 0;
+    for (int i = 0; i < 9; i++) {
+        int idx = IDX_FROM_UNIT(unit, i);
+        if (idx == match->roof[0] || idx == match->roof[1]) continue;
+        if (index->cands[idx] != 0) others[num_others++] = idx;
+    }
+
+    for (int set = 1; set < (1 << num_others); set++) {
+        int size = __builtin_popcount(set);
+        if (size > MAX_UR_SET_SIZE) continue;
+
+        unsigned int set_cands = match->extras;
+        Bitboard set_cells = bb_empty();
+        for (int i = 0; i < num_others; i++) {
+            if (!IS_BIT_SET(set, i)) continue;
+            set_cands |= index->cands[others[i]];
+            bb_add(&set_cells, others[i]);
+        }
+        if (__builtin_popcount(set_cands) != size + 1) continue;
+
+        start_step(match, s);
+        s->set_cells = set_cells;
+        s->set_cands = cand_set_from_mask(set_cands);
+        for (int i = 0; i < num_others; i++) {
+            if (IS_BIT_SET(set, i)) continue;
+            add_removal(s, others[i], index->cands[others[i]] & set_cands);
+        }
+        if (s->num_removals == 0) continue;
+
+        if (!step_sink_emit(sink, step)) return false;
+    }
+
+    return true;
+}
+
+// One pair candidate only appears in the roof within a shared unit, so one
+// roof cell holds it. The other pair candidate would then complete the deadly
+// pattern in the other roof cell, so it goes from both
+static bool type_4(RectangleIndex *index, RectMatch *match, Step *step,
+                   StepSink *sink) {
+    UniqueRectangleStep *s = &step->as.unique_rectangle;
+    if (!find_roof(index, match)) return true;
+
+    Bitboard roof = bb_empty();
+    bb_add(&roof, match->roof[0]);
+    bb_add(&roof, match->roof[1]);
+
+    int units[2];
+    int num_units = shared_units(match->roof[0], match->roof[1], units);
+    for (int i = 0; i < num_units; i++) {
+        for (int digit = 1; digit <= 9; digit++) {
+            if (!IS_BIT_SET(match->pair, digit - 1)) continue;
+
+            Bitboard in_unit = bb_and(index->cells_with[digit - 1],
+                                      unit_cells[units[i]]);
+            if (!bb_is_empty(bb_and_not(in_unit, roof))) continue;
+
+            unsigned int other = UNSET_BIT(match->pair, digit - 1);
+            start_step(match, s);
+            s->set_cands = cand_set_from_values(1, digit);
+            add_removal(s, match->roof[0], other);
+            add_removal(s, match->roof[1], other);
+
+            if (!step_sink_emit(sink, step)) return false;
+        }
+    }
+
+    return true;
+}
+
+static void start_step(RectMatch *match, UniqueRectangleStep *s) {
+    s->corners[0] = match->rect->idxs[0];
+    s->corners[1] = match->rect->idxs[3];
+    s->cands = cand_set_from_mask(match->pair);
+    s->set_cells = bb_empty();
+    s->set_cands = cand_set_empty();
+    s->num_removals = 0;
+}
+
+static void add_removal(UniqueRectangleStep *s, int idx, unsigned int cands) {
+    if (cands == 0) return;
+
+    s->removal_idxs[s->num_removals] = idx;
+    s->removed_cands[s->num_removals] = cand_set_from_mask(cands);
+    s->num_removals++;
+}
+
+static void rectangle_idxs(int corners[2], int out[4]) {
+    int r1 = ROW_FROM_IDX(corners[0]);
+    int c1 = COL_FROM_IDX(corners[0]);
+    int r2 = ROW_FROM_IDX(corners[1]);
+    int c2 = COL_FROM_IDX(corners[1]);
+
+    out[0] = IDX_FROM_ROW_COL(r1, c1);
+    out[1] = IDX_FROM_ROW_COL(r1, c2);
+    out[2] = IDX_FROM_ROW_COL(r2, c1);
+    out[3] = IDX_FROM_ROW_COL(r2, c2);
+}
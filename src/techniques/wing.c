@@ -0,0 +1,359 @@
+#include "techniques/wing.h"
+
+#include <stdbool.h>
+
+#include "bitboard.h"
+#include "cand_set.h"
+#include "cell.h"
+#include "codec.h"
+#include "dynstr.h"
+#include "grid.h"
+#include "links.h"
+#include "step.h"
+#include "step_effects.h"
+#include "step_sink.h"
+#include "ui.h"
+#include "techniques/explain.h"
+
+// Bivalue cells grouped by their pair, in both orders, and the cells holding
+// each candidate. The pincers of a wing then come out of a mask operation on
+// the pivot's peers instead of a scan over them
+typedef struct {
+    Bitboard pairs[9][9];
+    Bitboard cands[9];
+} WingIndex;
+
+static void wing_index_build(Grid *grid, WingIndex *index);
+static bool pivot_wings(Grid *grid, WingIndex *index, int pivot, int z,
+                        Step *step, StepSink *sink);
+static bool find_w_link(Grid *grid, LinkGraph *links, int a, int b,
+                        int link_value, int out[2]);
+static bool emit_wing(Step *step, StepSink *sink, Bitboard removals);
+
+bool xy_wing(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_XY_WING};
+    WingIndex index;
+    wing_index_build(grid, &index);
+
+    for (int pivot = 0; pivot < 81; pivot++) {
+        if (grid->cells[pivot]->cands.len != 2) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        for (int z = 1; z <= 9; z++) {
+            if (cell_has_cand(grid->cells[pivot], z)) continue;
+            if (!pivot_wings(grid, &index, pivot, z, &step, sink)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool xyz_wing(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_XYZ_WING};
+    WingIndex index;
+    wing_index_build(grid, &index);
+
+    for (int pivot = 0; pivot < 81; pivot++) {
+        if (grid->cells[pivot]->cands.len != 3) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        for (int z = 1; z <= 9; z++) {
+            if (!cell_has_cand(grid->cells[pivot], z)) continue;
+            if (!pivot_wings(grid, &index, pivot, z, &step, sink)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Two cells with the same pair {x, y} that don't see each other, and a strong
+// link on x whose ends see one cell each. One of the cells must be y, so y
+// goes from every cell seeing both
+bool w_wing(Grid *grid, StepSink *sink) {
+    Step step = {.tech = TECH_W_WING};
+    WingStep *s = &step.as.wing;
+    WingIndex index;
+    wing_index_build(grid, &index);
+    LinkGraph *links = grid_links(grid);
+
+    for (int a = 0; a < 81; a++) {
+        CandSet pair = grid->cells[a]->cands;
+        if (pair.len != 2) continue;
+        if (grid_is_cancelled(grid)) return false;
+
+        int xy[2];
+        cand_set_to_arr(pair, xy);
+
+        Bitboard others = bb_and_not(index.pairs[xy[0] - 1][xy[1] - 1],
+                                     grid->peer_masks[a]);
+        int bs[81];
+        int num_bs = bb_to_idxs(others, bs);
+
+        for (int i = 0; i < num_bs; i++) {
+            int b = bs[i];
+            if (b <= a) continue;
+
+            for (int l = 0; l < 2; l++) {
+                int link_value = xy[l];
+                int value = xy[1 - l];
+
+                Bitboard removals = bb_and(
+                    index.cands[value - 1],
+                    bb_and(grid->peer_masks[a], grid->peer_masks[b]));
+                if (bb_is_empty(removals)) continue;
+                if (!find_w_link(grid, links, a, b, link_value, s->link_idxs)) {
+                    continue;
+                }
+
+                s->pivot_idx = -1;
+                s->pincer_idxs[0] = a;
+                s->pincer_idxs[1] = b;
+                s->pincer_cands[0] = pair;
+                s->pincer_cands[1] = pair;
+                s->link_value = link_value;
+                s->value = value;
+
+                if (!emit_wing(&step, sink, removals)) return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void wing_apply(Grid *grid, Step *step) {
+    WingStep *s = &step->as.wing;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_remove_cand(grid->cells[s->removal_idxs[i]], s->value);
+    }
+}
+
+void wing_revert(Grid *grid, Step *step) {
+    WingStep *s = &step->as.wing;
+
+    for (int i = 0; i < s->num_removals; i++) {
+        cell_add_cand(grid->cells[s->removal_idxs[i]], s->value);
+    }
+}
+
+void wing_explain(DynStr *ds, Step *step) {
+    WingStep *s = &step->as.wing;
+
+    if (step->tech == TECH_W_WING) {
+        ds_append(ds, "[W-Wing] ");
+        print_cand_set(ds, s->pincer_cands[0]);
+        ds_append(ds, " in ");
+        print_idxs(ds, s->pincer_idxs, 2);
+        ds_appendf(ds, ", linked by {%d} in ", s->link_value);
+        print_idxs(ds, s->link_idxs, 2);
+    } else {
+        ds_appendf(ds, "[%s] ", step->tech == TECH_XY_WING ? "XY-Wing"
+                                                           : "XYZ-Wing");
+        print_idxs(ds, &s->pivot_idx, 1);
+        ds_append(ds, " ");
+        print_cand_set(ds, s->pivot_cands);
+        ds_append(ds, " with pincers ");
+        print_idxs(ds, &s->pincer_idxs[0], 1);
+        ds_append(ds, " ");
+        print_cand_set(ds, s->pincer_cands[0]);
+        ds_append(ds, " and ");
+        print_idxs(ds, &s->pincer_idxs[1], 1);
+        ds_append(ds, " ");
+        print_cand_set(ds, s->pincer_cands[1]);
+    }
+    ds_append(ds, ":\n");
+
+    for (int i = 0; i < s->num_removals; i++) {
+        int row = ROW_FROM_IDX(s->removal_idxs[i]);
+        int col = COL_FROM_IDX(s->removal_idxs[i]);
+
+        ds_appendf(ds, "- Removed {%d} from r%dc%d\n", s->value, row + 1,
+                   col + 1);
+    }
+}
+
+void wing_colorise(ColorPair colors[81][9], Step *step) {
+    WingStep *s = &step->as.wing;
+
+    if (step->tech != TECH_W_WING) {
+        for (int cand = 1; cand <= 9; cand++) {
+            if (cand_set_has(s->pivot_cands, cand)) {
+                colors[s->pivot_idx][cand - 1] = CP_TRIGGER;
+            }
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        int idx = s->pincer_idxs[i];
+        for (int cand = 1; cand <= 9; cand++) {
+            if (cand_set_has(s->pincer_cands[i], cand)) {
+                colors[idx][cand - 1] = cand == s->value ? CP_SPECIAL
+                                                         : CP_TRIGGER;
+            }
+        }
+    }
+    if (step->tech == TECH_W_WING) {
+        for (int i = 0; i < 2; i++) {
+            colors[s->link_idxs[i]][s->link_value - 1] = CP_TRIGGER;
+        }
+    }
+    for (int i = 0; i < s->num_removals; i++) {
+        colors[s->removal_idxs[i]][s->value - 1] = CP_REMOVAL;
+    }
+}
+
+void wing_encode(Bytes *out, Step *step) {
+    WingStep *s = &step->as.wing;
+
+    if (step->tech == TECH_W_WING) {
+        encode_idxs(out, s->link_idxs, 2);
+        encode_uint(out, s->link_value);
+    } else {
+        encode_uint(out, s->pivot_idx);
+        encode_cand_set(out, s->pivot_cands);
+    }
+    encode_idxs(out, s->pincer_idxs, 2);
+    encode_cand_set(out, s->pincer_cands[0]);
+    encode_cand_set(out, s->pincer_cands[1]);
+    encode_uint(out, s->value);
+    encode_idxs(out, s->removal_idxs, s->num_removals);
+}
+
+void wing_decode(Decoder *in, Step *step) {
+    WingStep *s = &step->as.wing;
+
+    if (step->tech == TECH_W_WING) {
+        if (decode_idxs(in, s->link_idxs, 2) != 2) {
+            in->failed = true;
+        }
+        s->link_value = decode_digit(in);
+        s->pivot_idx = -1;
+    } else {
+        s->pivot_idx = decode_idx(in);
+        s->pivot_cands = decode_cand_set(in);
+    }
+    if (decode_idxs(in, s->pincer_idxs, 2) != 2) {
+        in->failed = true;
+    }
+    s->pincer_cands[0] = decode_cand_set(in);
+    s->pincer_cands[1] = decode_cand_set(in);
+    s->value = decode_digit(in);
+    s->num_removals = decode_idxs(in, s->removal_idxs,
+                                  MAX_WING_REMOVALS);
+}
+
+void wing_effects(StepEffects *out, Step *step) {
+    WingStep *s = &step->as.wing;
+
+    CandSet cands = cand_set_from_values(1, s->value);
+    for (int i = 0; i < s->num_removals; i++) {
+        step_effects_remove(out, s->removal_idxs[i], cands);
+    }
+}
+
+static void wing_index_build(Grid *grid, WingIndex *index) {
+    for (int a = 0; a < 9; a++) {
+        index->cands[a] = bb_empty();
+        for (int b = 0; b < 9; b++) {
+            index->pairs[a][b] = bb_empty();
+        }
+    }
+
+    for (int idx = 0; idx < 81; idx++) {
+        Cell *cell = grid->cells[idx];
+
+        int cands[9];
+        int num_cands = cand_set_to_arr(cell->cands, cands);
+        for (int i = 0; i < num_cands; i++) {
+            bb_add(&index->cands[cands[i] - 1], idx);
+        }
+
+        if (num_cands == 2) {
+            bb_add(&index->pairs[cands[0] - 1][cands[1] - 1], idx);
+            bb_add(&index->pairs[cands[1] - 1][cands[0] - 1], idx);
+        }
+    }
+}
+
+// Emits every wing around pivot that removes z. The pincers are pivot's other
+// candidates paired with z. An XY-Wing's pivot doesn't hold z, so z goes from
+// the cells seeing both pincers. An XYZ-Wing's pivot holds it too, so those
+// cells must also see the pivot
+static bool pivot_wings(Grid *grid, WingIndex *index, int pivot, int z,
+                        Step *step, StepSink *sink) {
+    WingStep *s = &step->as.wing;
+    Cell *cell = grid->cells[pivot];
+    Bitboard peers = grid->peer_masks[pivot];
+
+    int xy[2];
+    cand_set_to_arr(cand_set_difference(cell->cands,
+                                        cand_set_from_values(1, z)),
+                    xy);
+
+    int as[NUM_PEERS];
+    int bs[NUM_PEERS];
+    int num_as = bb_to_idxs(bb_and(index->pairs[xy[0] - 1][z - 1], peers), as);
+    int num_bs = bb_to_idxs(bb_and(index->pairs[xy[1] - 1][z - 1], peers), bs);
+
+    Bitboard targets = index->cands[z - 1];
+    if (cell_has_cand(cell, z)) {
+        targets = bb_and(targets, peers);
+    }
+
+    for (int i = 0; i < num_as; i++) {
+        for (int j = 0; j < num_bs; j++) {
+            int a = as[i];
+            int b = bs[j];
+
+            Bitboard removals = bb_and(
+                targets, bb_and(grid->peer_masks[a], grid->peer_masks[b]));
+            if (bb_is_empty(removals)) continue;
+
+            s->pivot_idx = pivot;
+            s->pivot_cands = cell->cands;
+            s->pincer_idxs[0] = a;
+            s->pincer_idxs[1] = b;
+            s->pincer_cands[0] = grid->cells[a]->cands;
+            s->pincer_cands[1] = grid->cells[b]->cands;
+            s->value = z;
+
+            if (!emit_wing(step, sink, removals)) return false;
+        }
+    }
+
+    return true;
+}
+
+// Looks for a strong link on link_value between a peer of a and a peer of b
+static bool find_w_link(Grid *grid, LinkGraph *links, int a, int b,
+                        int link_value, int out[2]) {
+    int starts[NUM_PEERS];
+    int num_starts = bb_to_idxs(grid->peer_masks[a], starts);
+
+    for (int i = 0; i < num_starts; i++) {
+        int node = NODE(starts[i], link_value);
+        if (!links_has_node(links, node)) continue;
+
+        for (int kind = LINK_ROW; kind <= LINK_BOX; kind++) {
+            int partner = links->strong[node][kind];
+            if (partner == NO_LINK) continue;
+            if (!bb_has(grid->peer_masks[b], NODE_IDX(partner))) continue;
+
+            out[0] = starts[i];
+            out[1] = NODE_IDX(partner);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool emit_wing(Step *step, StepSink *sink, Bitboard removals) {
+    WingStep *s = &step->as.wing;
+    s->num_removals = bb_to_idxs(removals, s->removal_idxs);
+    return step_sink_emit(sink, step);
+}
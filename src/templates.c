@@ -0,0 +1,178 @@
+#include "templates.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "bits.h"
+#include "cell.h"
+
+// Templates are generated a row at a time, so the ones sharing their first row
+// cell are contiguous, and each of those blocks fills whole survivor words
+#define TEMPLATES_PER_COL (NUM_TEMPLATES / 9)
+#define WORDS_PER_COL (TEMPLATES_PER_COL / 64)
+
+static Bitboard templates[NUM_TEMPLATES];
+static pthread_once_t templates_once = PTHREAD_ONCE_INIT;
+
+static void build_templates(void);
+static int add_templates(int row, int used_cols, int used_stacks,
+                         Bitboard cells, int count);
+static void filter_all(TemplateIndex *index, int d);
+static void filter_survivors(TemplateIndex *index, int d);
+static unsigned long long template_fits(Bitboard template, Bitboard allowed,
+                                        Bitboard placed);
+
+void templates_init(TemplateIndex *index) {
+    index->is_built = false;
+}
+
+// Brings the survivors up to date with cells. Solving only takes places away
+// from a digit, so its survivors can be filtered again on their own. A digit
+// that gained a place, after a step was reverted, is filtered from scratch
+void templates_update(TemplateIndex *index, Cell cells[81]) {
+    pthread_once(&templates_once, build_templates);
+
+    for (int digit = 1; digit <= 9; digit++) {
+        Bitboard allowed = bb_empty();
+        Bitboard placed = bb_empty();
+        for (int idx = 0; idx < 81; idx++) {
+            if (cells[idx].value == digit) {
+                bb_add(&placed, idx);
+                bb_add(&allowed, idx);
+            } else if (cell_has_cand(&cells[idx], digit)) {
+                bb_add(&allowed, idx);
+            }
+        }
+
+        int d = digit - 1;
+        bool has_narrowed = false;
+        if (index->is_built) {
+            if (bb_equal(allowed, index->allowed[d])
+                && bb_equal(placed, index->placed[d])) {
+                continue;
+            }
+            has_narrowed =
+                bb_is_empty(bb_and_not(allowed, index->allowed[d]))
+                && bb_is_empty(bb_and_not(index->placed[d], placed));
+        }
+
+        index->allowed[d] = allowed;
+        index->placed[d] = placed;
+        if (has_narrowed) {
+            filter_survivors(index, d);
+        } else {
+            filter_all(index, d);
+        }
+    }
+
+    index->is_built = true;
+}
+
+static void build_templates(void) {
+    add_templates(0, 0, 0, bb_empty(), 0);
+}
+
+// Places the digit in row and every row below it, given the columns already
+// used and the stacks used within the current band. Returns the new count
+static int add_templates(int row, int used_cols, int used_stacks,
+                         Bitboard cells, int count) {
+    if (row == 9) {
+        templates[count] = cells;
+        return count + 1;
+    }
+    if (row % 3 == 0) {
+        used_stacks = 0;
+    }
+
+    for (int col = 0; col < 9; col++) {
+        if (IS_BIT_SET(used_cols, col) || IS_BIT_SET(used_stacks, col / 3)) {
+            continue;
+        }
+
+        Bitboard next = cells;
+        bb_add(&next, IDX_FROM_ROW_COL(row, col));
+        count = add_templates(row + 1, SET_BIT(used_cols, col),
+                              SET_BIT(used_stacks, col / 3), next, count);
+    }
+
+    return count;
+}
+
+// Tests every template, skipping the blocks whose first row cell can't hold
+// the digit. The inner loop has no branches, so it stays a straight run of
+// 64-bit ANDs the compiler can vectorise
+static void filter_all(TemplateIndex *index, int d) {
+    Bitboard allowed = index->allowed[d];
+    Bitboard placed = index->placed[d];
+    Bitboard possible = bb_empty();
+    int count = 0;
+
+    for (int col = 0; col < 9; col++) {
+        unsigned long long *words = &index->survivors[d][col * WORDS_PER_COL];
+        if (!bb_has(allowed, IDX_FROM_ROW_COL(0, col))) {
+            memset(words, 0, WORDS_PER_COL * sizeof(*words));
+            continue;
+        }
+
+        Bitboard *block = &templates[col * TEMPLATES_PER_COL];
+        for (int word = 0; word < WORDS_PER_COL; word++) {
+            unsigned long long bits = 0;
+            for (int i = 0; i < 64; i++) {
+                Bitboard template = block[word * 64 + i];
+                unsigned long long fits = template_fits(template, allowed,
+                                                        placed);
+                bits |= fits << i;
+                possible.lo |= template.lo & -fits;
+                possible.hi |= template.hi & -fits;
+            }
+            words[word] = bits;
+            count += __builtin_popcountll(bits);
+        }
+    }
+
+    index->num_survivors[d] = count;
+    index->possible[d] = possible;
+}
+
+// Only tests the templates that survived last time, dropping the ones that no
+// longer fit
+static void filter_survivors(TemplateIndex *index, int d) {
+    Bitboard allowed = index->allowed[d];
+    Bitboard placed = index->placed[d];
+    Bitboard possible = bb_empty();
+    int count = 0;
+
+    for (int word = 0; word < TEMPLATE_WORDS; word++) {
+        unsigned long long bits = index->survivors[d][word];
+        unsigned long long kept = 0;
+        while (bits) {
+            int i = __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            Bitboard template = templates[word * 64 + i];
+            if (template_fits(template, allowed, placed)) {
+                kept |= 1ull << i;
+                possible.lo |= template.lo;
+                possible.hi |= template.hi;
+            }
+        }
+        index->survivors[d][word] = kept;
+        count += __builtin_popcountll(kept);
+    }
+
+    index->num_survivors[d] = count;
+    index->possible[d] = possible;
+}
+
+// 1 if template only uses allowed cells and covers every placed one, else 0.
+// Written out on the halves so the hot loops don't call into bitboard.c
+static unsigned long long template_fits(Bitboard template, Bitboard allowed,
+                                        Bitboard placed) {
+    unsigned long long misses = (template.lo & ~allowed.lo)
+                                | (template.hi & ~allowed.hi)
+                                | (placed.lo & ~template.lo)
+                                | (placed.hi & ~template.hi);
+    return misses == 0;
+}
@@ -0,0 +1,271 @@
+#include "trace.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "codec.h"
+#include "dynarr.h"
+#include "grid.h"
+#include "history.h"
+#include "solver.h"
+#include "step.h"
+
+// File layout. All integers are little endian
+//
+// Header:
+//   char magic[4]       "HLMT"
+//   u32  version
+//   u32  num_puzzles
+//   u32  reserved
+//   u64  index_offset   Position of the puzzle index
+//
+// Puzzle record, one per puzzle:
+//   char grid[165]      Initial grid in S9B format, without terminator
+//   u8   status         SolveStatus reached by the solver
+//   u32  num_steps
+//   u32  step_offsets[num_steps]   Relative to the start of the step data
+//   u8   steps[]        Steps encoded with step_encode
+//
+// Index:
+//   u64  puzzle_offsets[num_puzzles]
+
+#define TRACE_MAGIC "HLMT"
+#define TRACE_VERSION 2
+#define HEADER_SIZE 24
+#define INDEX_OFFSET_POS 16
+#define STATUS_POS CANDS_STR_LEN
+#define NUM_STEPS_POS (STATUS_POS + 1)
+#define STEP_OFFSETS_POS (NUM_STEPS_POS + 4)
+
+static bool write_u32(FILE *file, unsigned long value);
+static bool write_u64(FILE *file, unsigned long long value);
+static unsigned long read_u32(unsigned char *data);
+static unsigned long long read_u64(unsigned char *data);
+static unsigned char *puzzle_record(TraceReader *reader, int puzzle);
+static bool is_grid_str(unsigned char *str);
+
+bool trace_writer_open(TraceWriter *writer, char *path) {
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return false;
+    da_init(&writer->index);
+
+    // The header is rewritten with the real counts on close
+    fwrite(TRACE_MAGIC, 1, 4, writer->file);
+    write_u32(writer->file, TRACE_VERSION);
+    write_u32(writer->file, 0);
+    write_u32(writer->file, 0);
+    return write_u64(writer->file, 0);
+}
+
+// Writes one puzzle record. grid_str is the initial grid in S9B format and hist
+// holds every step the solver took from it
+bool trace_writer_add(TraceWriter *writer, char *grid_str, SolveStatus status,
+                      History *hist) {
+    da_append(&writer->index, ftell(writer->file));
+
+    fwrite(grid_str, 1, CANDS_STR_LEN, writer->file);
+    fputc(status, writer->file);
+    write_u32(writer->file, history_len(hist));
+    for (int i = 0; i < history_len(hist); i++) {
+        write_u32(writer->file, hist->offsets.elems[i]);
+    }
+    if (hist->data.len) {
+        fwrite(hist->data.elems, 1, hist->data.len, writer->file);
+    }
+
+    return !ferror(writer->file);
+}
+
+bool trace_writer_close(TraceWriter *writer) {
+    long index_offset = ftell(writer->file);
+    for (int i = 0; i < writer->index.len; i++) {
+        write_u64(writer->file, writer->index.elems[i]);
+    }
+
+    fseek(writer->file, 8, SEEK_SET);
+    write_u32(writer->file, writer->index.len);
+    fseek(writer->file, INDEX_OFFSET_POS, SEEK_SET);
+    write_u64(writer->file, index_offset);
+
+    bool ok = !ferror(writer->file);
+    ok = fclose(writer->file) == 0 && ok;
+    da_deinit(&writer->index);
+
+    return ok;
+}
+
+// Only checks the header and that the index fits. Records are checked as they
+// are read, so opening doesn't touch the whole file
+bool trace_reader_open(TraceReader *reader, char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+
+    reader->size = st.st_size;
+    reader->data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->data == MAP_FAILED) return false;
+
+    unsigned long long index_offset = read_u64(reader->data + INDEX_OFFSET_POS);
+    unsigned long num_puzzles = read_u32(reader->data + 8);
+
+    if (memcmp(reader->data, TRACE_MAGIC, 4) != 0
+        || read_u32(reader->data + 4) != TRACE_VERSION
+        || index_offset < HEADER_SIZE || index_offset > reader->size
+        || num_puzzles > INT_MAX
+        || (reader->size - index_offset) / 8 < num_puzzles) {
+        trace_reader_close(reader);
+        return false;
+    }
+
+    reader->records_end = index_offset;
+    reader->num_puzzles = num_puzzles;
+    return true;
+}
+
+void trace_reader_close(TraceReader *reader) {
+    munmap(reader->data, reader->size);
+}
+
+// Reads the whole record of a puzzle, so the other functions can't fail on it
+// afterwards. Returns false if any part of it is malformed
+bool trace_reader_check(TraceReader *reader, int puzzle) {
+    unsigned char *record = puzzle_record(reader, puzzle);
+    if (!record || !is_grid_str(record)) return false;
+    if (record[STATUS_POS] > SOLVE_BAD_STEP) return false;
+
+    Step step;
+    int num_steps = trace_reader_num_steps(reader, puzzle);
+    for (int i = 0; i < num_steps; i++) {
+        if (!trace_reader_step(reader, puzzle, i, &step)) return false;
+    }
+    return true;
+}
+
+// Returns NULL if the record is malformed
+Grid *trace_reader_grid(TraceReader *reader, int puzzle) {
+    unsigned char *record = puzzle_record(reader, puzzle);
+    if (!record || !is_grid_str(record)) return NULL;
+
+    char grid_str[CANDS_STR_LEN + 1];
+    memcpy(grid_str, record, CANDS_STR_LEN);
+    grid_str[CANDS_STR_LEN] = '\0';
+    return grid_create(grid_str);
+}
+
+// Returns SOLVE_INVALID if the record is malformed
+SolveStatus trace_reader_status(TraceReader *reader, int puzzle) {
+    unsigned char *record = puzzle_record(reader, puzzle);
+    if (!record || record[STATUS_POS] > SOLVE_BAD_STEP) return SOLVE_INVALID;
+    return record[STATUS_POS];
+}
+
+// Returns -1 if the record is malformed
+int trace_reader_num_steps(TraceReader *reader, int puzzle) {
+    unsigned char *record = puzzle_record(reader, puzzle);
+    if (!record) return -1;
+    return read_u32(record + NUM_STEPS_POS);
+}
+
+// Decodes step i of a puzzle into out. Returns out, or NULL if there is no
+// such step or it is malformed
+Step *trace_reader_step(TraceReader *reader, int puzzle, int i, Step *out) {
+    if (i < 0 || i >= trace_reader_num_steps(reader, puzzle)) return NULL;
+
+    unsigned char *record = puzzle_record(reader, puzzle);
+    int num_steps = read_u32(record + NUM_STEPS_POS);
+    unsigned char *steps = record + STEP_OFFSETS_POS + num_steps * 4;
+    size_t steps_len = reader->data + reader->records_end - steps;
+
+    unsigned long offset = read_u32(record + STEP_OFFSETS_POS + i * 4);
+    if (offset >= steps_len) return NULL;
+    if (step_decode(steps + offset, steps_len - offset, out) < 0) return NULL;
+    return out;
+}
+
+static bool write_u32(FILE *file, unsigned long value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = value >> (i * 8);
+    }
+    return fwrite(bytes, 1, 4, file) == 4;
+}
+
+static bool write_u64(FILE *file, unsigned long long value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = value >> (i * 8);
+    }
+    return fwrite(bytes, 1, 8, file) == 8;
+}
+
+static unsigned long read_u32(unsigned char *data) {
+    unsigned long value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (unsigned long)data[i] << (i * 8);
+    }
+    return value;
+}
+
+static unsigned long long read_u64(unsigned char *data) {
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (unsigned long long)data[i] << (i * 8);
+    }
+    return value;
+}
+
+// Returns NULL if there is no such puzzle or its header and step offsets don't
+// fit before the index
+static unsigned char *puzzle_record(TraceReader *reader, int puzzle) {
+    if (puzzle < 0 || puzzle >= reader->num_puzzles) return NULL;
+
+    unsigned char *index = reader->data + reader->records_end;
+    unsigned long long offset = read_u64(index + puzzle * 8ull);
+    if (offset < HEADER_SIZE || offset > reader->records_end
+        || reader->records_end - offset < STEP_OFFSETS_POS) {
+        return NULL;
+    }
+
+    unsigned char *record = reader->data + offset;
+    unsigned long long num_steps = read_u32(record + NUM_STEPS_POS);
+    if ((reader->records_end - offset - STEP_OFFSETS_POS) / 4 < num_steps
+        || num_steps > INT_MAX) {
+        return NULL;
+    }
+    return record;
+}
+
+// Whether str holds the cells of an S9B grid, each no more than a placed value
+// or a candidate mask
+static bool is_grid_str(unsigned char *str) {
+    for (int i = 0; i < CANDS_STR_LEN - 3; i += 2) {
+        int cell_bits = 0;
+        for (int j = 0; j < 2; j++) {
+            unsigned char c = str[3 + i + j];
+            int digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'z') {
+                digit = c - 'a' + 10;
+            } else {
+                return false;
+            }
+            cell_bits = cell_bits * 36 + digit;
+        }
+        if (cell_bits > 18 + 0x1ff) return false;
+    }
+    return memcmp(str, "S9B", 3) == 0;
+}
@@ -3,28 +3,38 @@
 #include <locale.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <string.h>
 #include <wchar.h>
 
 #define NCURSES_WIDECHAR 1
 #include <ncurses.h>
 
 #include "cell.h"
-#include "dynarr.h"
 #include "dynstr.h"
+#include "explanation.h"
 #include "grid.h"
 #include "step.h"
 #include "techniques/registry.h"
 
 #define GRID_WIDTH 91
 #define GRID_HEIGHT 37
+#define CELL_WIDTH 10
+#define CELL_HEIGHT 4
 #define INFO_WIDTH (COLS - 2)
-#define INFO_HEIGHT (LINES - GRID_HEIGHT)
+#define INFO_HEIGHT (LINES - GRID_HEIGHT - 1)
+
+// How long ui_wait_for_input blocks before returning ACTION_NONE, so callers
+// can refresh state that changes in the background
+#define INPUT_TIMEOUT_MS 100
 
-static void ui_explain_step(Ui *ui, Step *step);
 static void ui_refresh_info(Ui *ui);
 static void ui_print_scroll_indicators(Ui *ui);
-static void ui_generate_lines(Ui *ui);
+static void ui_print_frame(Ui *ui);
+static void ui_print_cell(Ui *ui, Cell *cell, ColorPair colors[9]);
 static void generate_colors(ColorPair colors[81][9], Step *step);
+static InputAction action_from_key(int key);
+static bool is_repeatable(InputAction action);
+static InputAction opposite_action(InputAction action);
 
 void ui_init(Ui *ui) {
     setlocale(LC_ALL, "");
@@ -33,6 +43,7 @@ void ui_init(Ui *ui) {
     noecho();
     curs_set(0);
     keypad(stdscr, true);
+    timeout(INPUT_TIMEOUT_MS);
 
     start_color();
     use_default_colors();
@@ -44,8 +55,12 @@ void ui_init(Ui *ui) {
     ui->grid_win = newwin(GRID_HEIGHT, GRID_WIDTH, 0, (COLS - GRID_WIDTH) / 2);
     ui->info_win = newwin(INFO_HEIGHT, INFO_WIDTH + 1, GRID_HEIGHT, 0);
     ui->scroll_win = newwin(INFO_HEIGHT, 1, GRID_HEIGHT, COLS - 1);
-    ds_init(&ui->info_buf);
-    da_init(&ui->lines);
+    ui->status_win = newwin(1, COLS, LINES - 1, 0);
+    ui->list_win = newwin(LINES - 1, COLS, 0, 0);
+    ui->list_top = 0;
+    explanation_init(&ui->message);
+    ui->info = &ui->message;
+    ui->shadow.is_drawn = false;
 
     refresh();
 }
@@ -54,108 +69,87 @@ void ui_deinit(Ui *ui) {
     delwin(ui->grid_win);
     delwin(ui->info_win);
     delwin(ui->scroll_win);
-    ds_deinit(&ui->info_buf);
-    da_deinit(&ui->lines);
+    delwin(ui->status_win);
+    delwin(ui->list_win);
+    explanation_deinit(&ui->message);
     endwin();
 }
 
 void ui_print_message(Ui *ui, char *format, ...) {
-    wclear(ui->info_win);
+    va_list args;
+    va_start(args, format);
+
+    ds_clear(&ui->message.text);
+    ds_vappendf(&ui->message.text, format, args);
+    explanation_invalidate(&ui->message);
+
+    va_end(args);
+
+    ui_print_explanation(ui, &ui->message);
+}
+
+void ui_print_status(Ui *ui, char *format, ...) {
+    werase(ui->status_win);
 
     va_list args;
     va_start(args, format);
 
-    ds_clear(&ui->info_buf);
-    ds_vappendf(&ui->info_buf, format, args);
-    ui_generate_lines(ui);
+    vw_printw(ui->status_win, format, args);
 
     va_end(args);
 
-    ui->curr_line = 0;
-    ui_refresh_info(ui);
+    wnoutrefresh(ui->status_win);
 }
 
 void ui_print_grid(Ui *ui, Grid *grid, Step *step) {
-    wchar_t *top = L"┏━━━━━━━━━┯━━━━━━━━━┯━━━━━━━━━┳━━━━━━━━━┯━━━━━━━━━┯━━━━━━━"
-                   L"━━┳━━━━━━━━━┯━━━━━━━━━┯━━━━━━━━━┓";
-    wchar_t *row_sep = L"┠─────────┼─────────┼─────────╂─────────┼─────────┼───"
-                       L"──────╂─────────┼─────────┼─────────┨";
-    wchar_t *band_sep = L"┣━━━━━━━━━┿━━━━━━━━━┿━━━━━━━━━╋━━━━━━━━━┿━━━━━━━━━┿━━"
-                        L"━━━━━━━╋━━━━━━━━━┿━━━━━━━━━┿━━━━━━━━━┫";
-    wchar_t *bottom = L"┗━━━━━━━━━┷━━━━━━━━━┷━━━━━━━━━┻━━━━━━━━━┷━━━━━━━━━┷━━━━"
-                      L"━━━━━┻━━━━━━━━━┷━━━━━━━━━┷━━━━━━━━━┛";
-
     ColorPair colors[81][9] = {0};
     generate_colors(colors, step);
 
-    wclear(ui->grid_win);
-    for (int row = 0; row < 9; row++) {
-        if (row == 0) {
-            waddwstr(ui->grid_win, top);
-        } else if (row % 3 == 0) {
-            waddwstr(ui->grid_win, band_sep);
-        } else {
-            waddwstr(ui->grid_win, row_sep);
-        }
+    GridShadow *shadow = &ui->shadow;
+    if (!shadow->is_drawn) {
+        ui_print_frame(ui);
+    }
 
-        for (int subrow = 0; subrow < 3; subrow++) {
-            for (int col = 0; col < 9; col++) {
-                if (col % 3 == 0) {
-                    waddwstr(ui->grid_win, L"┃");
-                } else {
-                    waddwstr(ui->grid_win, L"│");
-                }
+    for (int idx = 0; idx < 81; idx++) {
+        Cell *cell = grid->cells[idx];
 
-                int idx = IDX_FROM_ROW_COL(row, col);
-                Cell *cell = grid->cells[idx];
-                if (cell_is_empty(cell)) {
-                    wprintw(ui->grid_win, " ");
-                    for (int cand = subrow * 3 + 1; cand <= subrow * 3 + 3;
-                         cand++) {
-                        if (cell_has_cand(cell, cand)) {
-                            ColorPair color = colors[idx][cand - 1];
-                            wattron(ui->grid_win, COLOR_PAIR(color));
-                            wprintw(ui->grid_win, "%d", cand);
-                            wattroff(ui->grid_win, COLOR_PAIR(color));
-                        } else {
-                            wprintw(ui->grid_win, " ");
-                        }
-
-                        if (cand != subrow * 3 + 3) {
-                            wprintw(ui->grid_win, "  ");
-                        }
-                    }
-                    wprintw(ui->grid_win, " ");
-                } else {
-                    if (subrow == 1) {
-                        if (cell->is_clue) {
-                            wattron(ui->grid_win, COLOR_PAIR(CP_CLUE));
-                        }
-                        wprintw(ui->grid_win, "    %d    ", cell->value);
-                        wattroff(ui->grid_win, COLOR_PAIR(CP_CLUE));
-                    } else {
-                        wprintw(ui->grid_win, "         ");
-                    }
-                }
-            }
-            waddwstr(ui->grid_win, L"┃");
+        if (shadow->is_drawn && shadow->values[idx] == cell->value
+            && shadow->cands[idx] == cell->cands.cands
+            && memcmp(shadow->colors[idx], colors[idx], sizeof(colors[idx]))
+                   == 0) {
+            continue;
         }
+
+        ui_print_cell(ui, cell, colors[idx]);
+
+        shadow->values[idx] = cell->value;
+        shadow->cands[idx] = cell->cands.cands;
+        memcpy(shadow->colors[idx], colors[idx], sizeof(colors[idx]));
     }
-    waddwstr(ui->grid_win, bottom);
-    wrefresh(ui->grid_win);
+
+    shadow->is_drawn = true;
+    wnoutrefresh(ui->grid_win);
 }
 
 void ui_print_step(Ui *ui, Step *step) {
-    ui_explain_step(ui, step);
-    ui_generate_lines(ui);
+    if (!step) return;
+    explanation_set_step(&ui->message, step);
+    ui_print_explanation(ui, &ui->message);
+}
+
+// Shows exp, which must outlive its use by the Ui. It's only rewrapped if the
+// info window width changed since it was last shown
+void ui_print_explanation(Ui *ui, Explanation *exp) {
+    explanation_wrap(exp, INFO_WIDTH);
+    ui->info = exp;
     ui->curr_line = 0;
     ui_refresh_info(ui);
 }
 
 void ui_scroll(Ui *ui, int delta) {
     ui->curr_line += delta;
-    if (ui->curr_line > ui->lines.len - INFO_HEIGHT) {
-        ui->curr_line = ui->lines.len - INFO_HEIGHT;
+    if (ui->curr_line > ui->info->lines.len - INFO_HEIGHT) {
+        ui->curr_line = ui->info->lines.len - INFO_HEIGHT;
     }
     if (ui->curr_line < 0) {
         ui->curr_line = 0;
@@ -164,47 +158,122 @@ void ui_scroll(Ui *ui, int delta) {
     ui_refresh_info(ui);
 }
 
-InputAction ui_wait_for_input(void) {
-    while (true) {
-        switch (getch()) {
-        case 'q': return ACTION_QUIT;
-        case 'p':
-        case KEY_BACKSPACE:
-        case KEY_LEFT: return ACTION_PREV;
-        case 'n':
-        case ' ':
-        case '\n':
-        case KEY_RIGHT: return ACTION_NEXT;
-        case 'k':
-        case KEY_UP: return ACTION_SCROLL_UP;
-        case 'j':
-        case KEY_DOWN: return ACTION_SCROLL_DOWN;
+// Shows rows in a list covering everything but the status line, with row
+// selected highlighted. The list only scrolls as far as needed to keep the
+// selected row in view
+void ui_print_list(Ui *ui, char **rows, int num_rows, int selected) {
+    int height = getmaxy(ui->list_win);
+    if (selected < ui->list_top) {
+        ui->list_top = selected;
+    }
+    if (selected >= ui->list_top + height) {
+        ui->list_top = selected - height + 1;
+    }
+
+    werase(ui->list_win);
+    for (int y = 0; y < height && ui->list_top + y < num_rows; y++) {
+        int i = ui->list_top + y;
+        if (i == selected) wattron(ui->list_win, A_REVERSE);
+        mvwaddnstr(ui->list_win, y, 0, rows[i], COLS);
+        if (i == selected) wattroff(ui->list_win, A_REVERSE);
+    }
+    wnoutrefresh(ui->list_win);
+}
+
+// Brings back the grid and info windows hidden by ui_print_list
+void ui_hide_list(Ui *ui) {
+    werase(ui->list_win);
+    wnoutrefresh(ui->list_win);
+
+    touchwin(ui->grid_win);
+    touchwin(ui->info_win);
+    touchwin(ui->scroll_win);
+    wnoutrefresh(ui->grid_win);
+    wnoutrefresh(ui->info_win);
+    wnoutrefresh(ui->scroll_win);
+}
+
+// Drawing functions only stage their windows, so all the changes since the last
+// input reach the terminal in a single update. Movement and scroll keys that
+// are already queued, e.g. from a held arrow key, are merged into a single
+// action with out_count repeats, opposite keys cancelling each other out
+InputAction ui_wait_for_input(int *out_count) {
+    doupdate();
+
+    InputAction action;
+    do {
+        int key = getch();
+        if (key == ERR) return ACTION_NONE;
+        action = action_from_key(key);
+    } while (action == ACTION_NONE);
+
+    int count = 1;
+    if (is_repeatable(action)) {
+        nodelay(stdscr, true);
+
+        int key;
+        while ((key = getch()) != ERR) {
+            InputAction queued = action_from_key(key);
+            if (queued == action) {
+                count++;
+            } else if (queued == opposite_action(action)) {
+                count--;
+            } else if (queued != ACTION_NONE) {
+                ungetch(key);
+                break;
+            }
         }
+
+        timeout(INPUT_TIMEOUT_MS);
+    }
+
+    if (count < 0) {
+        action = opposite_action(action);
+        count = -count;
+    } else if (count == 0) {
+        action = ACTION_NONE;
     }
+
+    if (out_count) {
+        *out_count = count;
+    }
+    return action;
 }
 
-static void ui_explain_step(Ui *ui, Step *step) {
-    if (!step) return;
-    ds_clear(&ui->info_buf);
-    technique_ops[step->tech].explain(&ui->info_buf, step);
+// Reads a line typed into the status window. Returns false if it's empty
+bool ui_prompt(Ui *ui, char *prompt, char *out, int max_len) {
+    werase(ui->status_win);
+    wprintw(ui->status_win, "%s", prompt);
+    wnoutrefresh(ui->status_win);
+    doupdate();
+
+    echo();
+    curs_set(1);
+
+    int result = wgetnstr(ui->status_win, out, max_len);
+
+    curs_set(0);
+    noecho();
+
+    return result != ERR && out[0] != '\0';
 }
 
 static void ui_refresh_info(Ui *ui) {
     int num_lines;
-    if (ui->lines.len < INFO_HEIGHT) {
-        num_lines = ui->lines.len;
+    if (ui->info->lines.len < INFO_HEIGHT) {
+        num_lines = ui->info->lines.len;
     } else {
         num_lines = INFO_HEIGHT;
     }
 
-    wclear(ui->info_win);
+    werase(ui->info_win);
     for (int i = 0; i < num_lines; i++) {
-        Line curr_line = ui->lines.elems[ui->curr_line + i];
+        Line curr_line = ui->info->lines.elems[ui->curr_line + i];
 
         wprintw(ui->info_win, "%.*s\n", curr_line.len,
-                ui->info_buf.elems + curr_line.start);
+                ui->info->text.elems + curr_line.start);
     }
-    wrefresh(ui->info_win);
+    wnoutrefresh(ui->info_win);
     ui_print_scroll_indicators(ui);
 }
 
@@ -217,31 +286,75 @@ static void ui_print_scroll_indicators(Ui *ui) {
     }
 
     wmove(ui->scroll_win, getmaxy(ui->scroll_win) - 1, 0);
-    if (ui->lines.len - ui->curr_line > INFO_HEIGHT) {
+    if (ui->info->lines.len - ui->curr_line > INFO_HEIGHT) {
         waddwstr(ui->scroll_win, L"↓");
     } else {
         wprintw(ui->scroll_win, " ");
     }
 
-    wrefresh(ui->scroll_win);
+    wnoutrefresh(ui->scroll_win);
 }
 
-static void ui_generate_lines(Ui *ui) {
-    int line_start = 0;
-    int line_len = 0;
+// The frame never changes, so it's drawn once and cells are drawn on top
+static void ui_print_frame(Ui *ui) {
+    wchar_t *top = L"┏━━━━━━━━━┯━━━━━━━━━┯━━━━━━━━━┳━━━━━━━━━┯━━━━━━━━━┯━━━━━━━"
+                   L"━━┳━━━━━━━━━┯━━━━━━━━━┯━━━━━━━━━┓";
+    wchar_t *row_sep = L"┠─────────┼─────────┼─────────╂─────────┼─────────┼───"
+                       L"──────╂─────────┼─────────┼─────────┨";
+    wchar_t *band_sep = L"┣━━━━━━━━━┿━━━━━━━━━┿━━━━━━━━━╋━━━━━━━━━┿━━━━━━━━━┿━━"
+                        L"━━━━━━━╋━━━━━━━━━┿━━━━━━━━━┿━━━━━━━━━┫";
+    wchar_t *bottom = L"┗━━━━━━━━━┷━━━━━━━━━┷━━━━━━━━━┻━━━━━━━━━┷━━━━━━━━━┷━━━━"
+                      L"━━━━━┻━━━━━━━━━┷━━━━━━━━━┷━━━━━━━━━┛";
 
-    da_clear(&ui->lines);
-    for (int i = 0; i < ui->info_buf.len; i++) {
-        if (ui->info_buf.elems[i] != '\n' && line_len != INFO_WIDTH) {
-            line_len++;
-            continue;
+    werase(ui->grid_win);
+    for (int row = 0; row < 9; row++) {
+        wchar_t *sep = row == 0 ? top : row % 3 == 0 ? band_sep : row_sep;
+        mvwaddwstr(ui->grid_win, row * CELL_HEIGHT, 0, sep);
+
+        for (int subrow = 1; subrow < CELL_HEIGHT; subrow++) {
+            int y = row * CELL_HEIGHT + subrow;
+            for (int col = 0; col <= 9; col++) {
+                wchar_t *border = col % 3 == 0 ? L"┃" : L"│";
+                mvwaddwstr(ui->grid_win, y, col * CELL_WIDTH, border);
+            }
         }
+    }
+    mvwaddwstr(ui->grid_win, 9 * CELL_HEIGHT, 0, bottom);
+}
 
-        Line line = {.start = line_start, .len = line_len};
-        da_append(&ui->lines, line);
+static void ui_print_cell(Ui *ui, Cell *cell, ColorPair colors[9]) {
+    int y = cell->row * CELL_HEIGHT + 1;
+    int x = cell->col * CELL_WIDTH + 1;
+
+    for (int subrow = 0; subrow < 3; subrow++) {
+        wmove(ui->grid_win, y + subrow, x);
+
+        if (cell_is_empty(cell)) {
+            wprintw(ui->grid_win, " ");
+            for (int cand = subrow * 3 + 1; cand <= subrow * 3 + 3; cand++) {
+                if (cell_has_cand(cell, cand)) {
+                    ColorPair color = colors[cand - 1];
+                    wattron(ui->grid_win, COLOR_PAIR(color));
+                    wprintw(ui->grid_win, "%d", cand);
+                    wattroff(ui->grid_win, COLOR_PAIR(color));
+                } else {
+                    wprintw(ui->grid_win, " ");
+                }
 
-        line_start = line_len == INFO_WIDTH ? i : i + 1;
-        line_len = 0;
+                if (cand != subrow * 3 + 3) {
+                    wprintw(ui->grid_win, "  ");
+                }
+            }
+            wprintw(ui->grid_win, " ");
+        } else if (subrow == 1) {
+            if (cell->is_clue) {
+                wattron(ui->grid_win, COLOR_PAIR(CP_CLUE));
+            }
+            wprintw(ui->grid_win, "    %d    ", cell->value);
+            wattroff(ui->grid_win, COLOR_PAIR(CP_CLUE));
+        } else {
+            wprintw(ui->grid_win, "         ");
+        }
     }
 }
 
@@ -249,3 +362,43 @@ static void generate_colors(ColorPair colors[81][9], Step *step) {
     if (!step) return;
     technique_ops[step->tech].colorise(colors, step);
 }
+
+static InputAction action_from_key(int key) {
+    switch (key) {
+    case 'q': return ACTION_QUIT;
+    case 'p':
+    case KEY_BACKSPACE:
+    case KEY_LEFT: return ACTION_PREV;
+    case 'n':
+    case ' ':
+    case '\n':
+    case KEY_RIGHT: return ACTION_NEXT;
+    case 'k':
+    case KEY_UP: return ACTION_SCROLL_UP;
+    case 'j':
+    case KEY_DOWN: return ACTION_SCROLL_DOWN;
+    case 'g':
+    case KEY_HOME: return ACTION_FIRST;
+    case 'G':
+    case KEY_END: return ACTION_LAST;
+    case '[': return ACTION_PREV_SAME_TECH;
+    case ']': return ACTION_NEXT_SAME_TECH;
+    case 't': return ACTION_FIND_TECH;
+    case ':': return ACTION_GOTO;
+    default: return ACTION_NONE;
+    }
+}
+
+static bool is_repeatable(InputAction action) {
+    return opposite_action(action) != ACTION_NONE;
+}
+
+static InputAction opposite_action(InputAction action) {
+    switch (action) {
+    case ACTION_PREV: return ACTION_NEXT;
+    case ACTION_NEXT: return ACTION_PREV;
+    case ACTION_SCROLL_UP: return ACTION_SCROLL_DOWN;
+    case ACTION_SCROLL_DOWN: return ACTION_SCROLL_UP;
+    default: return ACTION_NONE;
+    }
+}
@@ -0,0 +1,75 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rating.h"
+#include "step.h"
+
+static int check_weights(char *name, char *contents, bool want_ok,
+                         int want_bad_line);
+static bool load_from(char *contents, int *out_bad_line);
+
+// Loads weight files with indented entries, comments and blank lines, and
+// with bad lines that must be rejected by number. Returns the number of
+// checks that failed
+int main(void) {
+    int defaults[NUM_TECHNIQUES];
+    memcpy(defaults, rating_weights, sizeof(defaults));
+
+    int num_failed = 0;
+    num_failed += check_weights("indented", "  X-Wing: 31\n"
+                                            "\t# An indented comment\n"
+                                            "   \n"
+                                            "\tHidden Single :  13  \n",
+                                true, 0);
+    if (rating_weights[TECH_X_WING] != 31
+        || rating_weights[TECH_HIDDEN_SINGLE] != 13) {
+        printf("rating: indented entries weren't loaded\n");
+        num_failed++;
+    }
+
+    memcpy(rating_weights, defaults, sizeof(defaults));
+    num_failed += check_weights("trailing garbage",
+                                "# Weights\nNaked Single: 10xyz\n", false, 2);
+    num_failed += check_weights("truncated name", "X-Win: 30\n", false, 1);
+    num_failed += check_weights("missing colon", "  X-Wing 30\n", false, 1);
+    num_failed += check_weights("too heavy", "X-Wing: 10001\n", false, 1);
+    if (memcmp(rating_weights, defaults, sizeof(defaults)) != 0) {
+        printf("rating: a rejected file changed the weights\n");
+        num_failed++;
+    }
+
+    if (num_failed == 0) printf("rating: all weight files checked\n");
+    return num_failed;
+}
+
+static int check_weights(char *name, char *contents, bool want_ok,
+                         int want_bad_line) {
+    int bad_line;
+    bool ok = load_from(contents, &bad_line);
+    if (ok == want_ok && bad_line == want_bad_line) return 0;
+
+    printf("rating: %s: got %s on line %d, want %s on line %d\n", name,
+           ok ? "ok" : "error", bad_line, want_ok ? "ok" : "error",
+           want_bad_line);
+    return 1;
+}
+
+static bool load_from(char *contents, int *out_bad_line) {
+    char path[] = "/tmp/holmes-weights-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd == -1) {
+        *out_bad_line = -1;
+        return false;
+    }
+
+    FILE *file = fdopen(fd, "w");
+    fputs(contents, file);
+    fclose(file);
+
+    bool ok = rating_load_weights(path, out_bad_line);
+    unlink(path);
+    return ok;
+}